@@ -65,8 +65,15 @@ string manufacturer;
 string softwareVersion;
 
 
-// Function to parse the device configuration
-std::pair<uint64_t, uint64_t> parseDeviceConfig(const std::string &configFilePath, nlohmann::json &config) {
+// Function to get the label and file name suffix of a code block: none for the
+// first one (zkp_start, program_commitment.json), "_<region>" for the others
+std::string regionSuffix(size_t region) {
+  return region == 0 ? "" : "_" + to_string(region);
+}
+
+// Function to parse the device configuration; returns the code block line ranges.
+// "code_blocks": [[start, end], ...] labels several blocks, "code_block" a single one.
+std::vector<std::pair<uint64_t, uint64_t>> parseDeviceConfig(const std::string &configFilePath, nlohmann::json &config) {
   std::ifstream configFileStream(configFilePath, std::ifstream::binary);
   if (!configFileStream.is_open()) {
       throw std::runtime_error("Error: Fides commitmentGenerator cannot open " + configFilePath + " for reading proposes.\n");
@@ -77,8 +84,19 @@ std::pair<uint64_t, uint64_t> parseDeviceConfig(const std::string &configFilePat
 
   std::vector<uint64_t> linesToRead;
 
-  uint64_t startLine = config["code_block"][0].get<uint64_t>();
-  uint64_t endLine = config["code_block"][1].get<uint64_t>();
+  std::vector<std::pair<uint64_t, uint64_t>> codeBlocks;
+  if (config.contains("code_blocks")) {
+    for (const auto& block : config["code_blocks"]) {
+      codeBlocks.push_back({block[0].get<uint64_t>(), block[1].get<uint64_t>()});
+    }
+  } else {
+    codeBlocks.push_back({config["code_block"][0].get<uint64_t>(), config["code_block"][1].get<uint64_t>()});
+  }
+  for (size_t i = 0; i < codeBlocks.size(); i++) {
+    if (codeBlocks[i].first > codeBlocks[i].second || (i > 0 && codeBlocks[i].first <= codeBlocks[i - 1].second)) {
+      throw std::runtime_error("Error: The code blocks in device_config.json must be ordered and must not overlap.");
+    }
+  }
   Class = config["class"].get<uint64_t>();
   deviceType = config["deviceType"].get<string>();
   deviceIdType = config["deviceIdType"].get<string>();
@@ -101,7 +119,7 @@ std::pair<uint64_t, uint64_t> parseDeviceConfig(const std::string &configFilePat
   p   = classJsonData[class_value]["p"].get<uint64_t>();
   g   = classJsonData[class_value]["g"].get<uint64_t>();
 
-  return {startLine, endLine};
+  return codeBlocks;
 }
 
 // Function to read specified lines from assembly file
@@ -134,26 +152,36 @@ std::vector<std::string> readAssemblyLines(const std::string &assemblyFilePath,
 vector<vector<uint64_t>> vector_z(2, vector<uint64_t>(2, 0ll));
 
 
-// Function to modify assembly code and return the modified lines
-std::vector<std::string> modifyAssembly(const std::vector<std::string> &originalLines, uint64_t startLine, uint64_t endLine) {
+// Function to modify assembly code and return the modified lines. Every code
+// block gets its own zkp_start/zkp_end label pair (see regionSuffix) and its
+// instructions are collected in blockInstructions.
+std::vector<std::string> modifyAssembly(const std::vector<std::string> &originalLines,
+                                        const std::vector<std::pair<uint64_t, uint64_t>> &codeBlocks,
+                                        std::vector<std::vector<std::string>> &blockInstructions) {
     std::vector<std::string> modifiedLines;
-
-    for (size_t i = 0; i < originalLines.size(); ++i) {
-      if (i + 1 == startLine) {
-          modifiedLines.push_back(".global zkp_start");
-          modifiedLines.push_back("zkp_start: nop");
-          modifiedLines.push_back(originalLines[i]);
-          instructions.push_back(originalLines[i]);
-      } else if (i + 1 > startLine && i + 1 <= endLine) {
-          modifiedLines.push_back(originalLines[i]);
-          instructions.push_back(originalLines[i]);
-      } else if (i + 1 == endLine + 1) {
-          modifiedLines.push_back(".global zkp_end");
-          modifiedLines.push_back("zkp_end: nop");
-          modifiedLines.push_back(originalLines[i]);
-      } else {
-          modifiedLines.push_back(originalLines[i]);
+    blockInstructions.assign(codeBlocks.size(), {});
+
+    for (size_t i = 0; i <= originalLines.size(); ++i) {
+      // A block's end label goes before the next block's start label on the same line
+      for (size_t b = 0; b < codeBlocks.size(); ++b) {
+        if (i + 1 == codeBlocks[b].second + 1) {
+          modifiedLines.push_back(".global zkp_end" + regionSuffix(b));
+          modifiedLines.push_back("zkp_end" + regionSuffix(b) + ": nop");
+        }
+      }
+      if (i == originalLines.size()) {
+        break;
       }
+      for (size_t b = 0; b < codeBlocks.size(); ++b) {
+        if (i + 1 == codeBlocks[b].first) {
+          modifiedLines.push_back(".global zkp_start" + regionSuffix(b));
+          modifiedLines.push_back("zkp_start" + regionSuffix(b) + ": nop");
+        }
+        if (i + 1 >= codeBlocks[b].first && i + 1 <= codeBlocks[b].second) {
+          blockInstructions[b].push_back(originalLines[i]);
+        }
+      }
+      modifiedLines.push_back(originalLines[i]);
     }
 
     return modifiedLines;
@@ -565,13 +593,17 @@ int main(int argc, char* argv[]) {
   paramFileName = assemblyFilePath;
   paramFileName = paramFileName.substr(0, paramFileName.find_last_of('.')) + "_param.json";
   nlohmann::json config;
-  auto [startLine, endLine] = parseDeviceConfig(configFilePath, config);
-  if((endLine - startLine)+1 != n_g) {
-    throw std::runtime_error(
-      "Error: The 'code_block' range in device_config.json does not match the number of supported instructions (n_g) for the selected 'class'. "
-      "Please verify the 'code_block' and 'class' values in device_config.json."
-    );
+  auto codeBlocks = parseDeviceConfig(configFilePath, config);
+  for (const auto& block : codeBlocks) {
+    if((block.second - block.first)+1 != n_g) {
+      throw std::runtime_error(
+        "Error: The 'code_block' range in device_config.json does not match the number of supported instructions (n_g) for the selected 'class'. "
+        "Please verify the 'code_block' and 'class' values in device_config.json."
+      );
+    }
   }
+  uint64_t startLine = codeBlocks[0].first;
+  uint64_t endLine = codeBlocks[0].second;
   cout << "startLine: " << startLine << endl;
   cout << "endLine: " << endLine << endl;
   // modifyAndSaveAssembly(assemblyFilePath, newAssemblyFile, startLine, endLine);
@@ -581,7 +613,8 @@ int main(int argc, char* argv[]) {
   //     std::cout << "originalLines: " << i << std::endl;
   // }
 
-  auto modifiedLines = modifyAssembly(originalLines, startLine, endLine);
+  std::vector<std::vector<std::string>> blockInstructions;
+  auto modifiedLines = modifyAssembly(originalLines, codeBlocks, blockInstructions);
   uint64_t startLineIndex = (startLine > 3) ? startLine - 3 : 0;
   uint64_t endLineIndex = (endLine < modifiedLines.size()) ? endLine : modifiedLines.size() - 1;
   for (uint64_t i = startLineIndex; i <= startLineIndex + 5; i++) {
@@ -614,7 +647,15 @@ int main(int argc, char* argv[]) {
 
 
   // TODO: update this part to be dynamic
-  commitmentGenerator();
+  // One commitment per code block; the first keeps the original file names
+  std::string commitmentBase = commitmentFileName.substr(0, commitmentFileName.find_last_of('.'));
+  std::string paramBase = paramFileName.substr(0, paramFileName.find_last_of('.'));
+  for (size_t b = 0; b < codeBlocks.size(); b++) {
+    instructions = blockInstructions[b];
+    commitmentFileName = commitmentBase + regionSuffix(b) + ".json";
+    paramFileName = paramBase + regionSuffix(b) + ".json";
+    commitmentGenerator();
+  }
 
   writeToFile(newAssemblyFile, modifiedLines);
   
@@ -0,0 +1,45 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "decodeTable.h"
+#include "nativeTracer.h"
+#include <iostream>
+
+// Function to decode the code block of an ELF file
+bool DecodeTable::build(const string& elfPath, const string& startSymbol, const string& endSymbol) {
+  uint64_t startAddress;
+  vector<uint32_t> words;
+  if (!NativeTracer::readCodeBlock(elfPath, startSymbol, endSymbol, startAddress, words) || words.empty()) {
+    return false;
+  }
+
+  // The first word is the nop the label sits on
+  entries.clear();
+  uint32_t row = firstGateRow;
+  for (size_t i = 1; i < words.size(); i++) {
+    DecodedInstruction decoded = {};
+    decoded.encoding = words[i];
+    decoded.rd = uint8_t(destinationRegister(words[i]));
+    decoded.row = decoded.rd == 31 ? 0 : row++;
+    entries.push_back(decoded);
+  }
+  firstAddress = startAddress + 4;
+  return true;
+}
+
+// Function to relocate the table to the run-time address of the first instruction
+void DecodeTable::rebase(uint64_t firstInstructionAddress) {
+  firstAddress = firstInstructionAddress;
+}
@@ -0,0 +1,65 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DECODE_TABLE_H
+#define DECODE_TABLE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "executionTrace.h"
+
+using namespace std;
+
+// What the witness needs from one instruction of the code block
+struct DecodedInstruction {
+  uint32_t encoding;
+  uint8_t rd;          // destinationRegister(): 31 if it writes none of x0..x30
+  uint32_t row;        // z index (and R1CS row) the result is written to; 0 if rd is 31
+};
+
+// Index of the first gate in z = [1, x0..x30, 0, gates...]
+const uint32_t firstGateRow = 33;
+
+// Static decode of the code block between zkp_start and zkp_end, built once
+// per binary so the gdb text trace only needs each step's address and the line
+// of its destination register. The binary and streamed traces carry the
+// instruction word and call destinationRegister() on it directly.
+class DecodeTable {
+public:
+  // Function to decode the code block of an ELF file
+  bool build(const string& elfPath, const string& startSymbol = "zkp_start", const string& endSymbol = "zkp_end");
+
+  // Function to relocate the table given the run-time address of the block's
+  // first instruction (the one after the nop at zkp_start)
+  void rebase(uint64_t firstInstructionAddress);
+
+  // Function to look up the instruction at a run-time address; nullptr if it is outside the block
+  const DecodedInstruction* find(uint64_t pc) const {
+    uint64_t offset = pc - firstAddress;
+    if (offset % 4 != 0 || offset / 4 >= entries.size()) {
+      return nullptr;
+    }
+    return &entries[offset / 4];
+  }
+
+  size_t size() const { return entries.size(); }
+
+private:
+  vector<DecodedInstruction> entries;
+  uint64_t firstAddress = 0;
+};
+
+#endif  // DECODE_TABLE_H
@@ -0,0 +1,328 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "executionTrace.h"
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char traceMagic[4] = {'F', 'Z', 'T', 'R'};
+const uint16_t traceVersion = 2;
+const uint32_t spBit = 1u << 31;
+
+struct SnapshotRecord {
+  uint64_t pc;
+  uint32_t instruction;
+  uint32_t reserved;
+  uint64_t x[31];
+  uint64_t sp;
+};
+
+struct DeltaRecordHead {
+  uint64_t pc;
+  uint32_t instruction;
+  uint32_t changed;
+};
+
+// Function to print one register the way gdb's "info registers" does
+void printRegister(FILE* out, const char* name, uint64_t value) {
+  char hex[24];
+  snprintf(hex, sizeof(hex), "0x%llx", (unsigned long long)value);
+  fprintf(out, "%-15s%-19s%lld\n", name, hex, (long long)value);
+}
+
+void printRegisters(FILE* out, const RegisterSnapshot& registers) {
+  char name[8];
+  for (int i = 0; i < 31; i++) {
+    snprintf(name, sizeof(name), "x%d", i);
+    printRegister(out, name, registers.x[i]);
+  }
+  printRegister(out, "sp", registers.sp);
+  printRegister(out, "pc", registers.pc);
+}
+
+}  // namespace
+
+ExecutionTraceWriter::~ExecutionTraceWriter() {
+  if (file) {
+    close();
+  }
+}
+
+// Function to create the trace file
+bool ExecutionTraceWriter::open(const string& path, TraceMode traceMode) {
+  file = fopen(path.c_str(), "wb");
+  if (!file) {
+    cerr << "Error: Unable to create trace file " << path << endl;
+    return false;
+  }
+  setvbuf(file, nullptr, _IOFBF, 1 << 16);
+  mode = traceMode;
+  fileHeader = {};
+  steps = 0;
+  written = 0;
+  return true;
+}
+
+// Function to write the header once the code block has been reached
+bool ExecutionTraceWriter::begin(const RegisterSnapshot& initial, uint64_t zkpStart, uint64_t zkpEnd) {
+  memcpy(fileHeader.magic, traceMagic, sizeof(traceMagic));
+  fileHeader.version = traceVersion;
+  fileHeader.mode = uint16_t(mode);
+  fileHeader.registerCount = 31;
+  fileHeader.zkpStart = zkpStart;
+  fileHeader.zkpEnd = zkpEnd;
+  fileHeader.initial = initial;
+  previous = initial;
+  if (fwrite(&fileHeader, sizeof(fileHeader), 1, file) != 1) {
+    return false;
+  }
+  written += sizeof(fileHeader);
+  return true;
+}
+
+// Function to append one retired instruction
+bool ExecutionTraceWriter::append(const TraceStep& step) {
+  if (mode == TraceMode::Snapshot) {
+    SnapshotRecord record = {};
+    record.pc = step.pc;
+    record.instruction = step.instruction;
+    memcpy(record.x, step.registers.x, sizeof(record.x));
+    record.sp = step.registers.sp;
+    if (fwrite(&record, sizeof(record), 1, file) != 1) {
+      return false;
+    }
+    written += sizeof(record);
+  } else if (mode == TraceMode::Destination) {
+    uint8_t record[sizeof(uint32_t) + sizeof(uint64_t)];
+    size_t length = sizeof(uint32_t);
+    memcpy(record, &step.instruction, sizeof(uint32_t));
+    uint32_t rd = destinationRegister(step.instruction);
+    if (rd != 31) {
+      memcpy(record + length, &step.registers.x[rd], sizeof(uint64_t));
+      length += sizeof(uint64_t);
+    }
+    if (fwrite(record, 1, length, file) != length) {
+      return false;
+    }
+    written += length;
+  } else {
+    DeltaRecordHead head = { step.pc, step.instruction, 0 };
+    uint64_t values[32];
+    int count = 0;
+    for (int i = 0; i < 31; i++) {
+      if (step.registers.x[i] != previous.x[i]) {
+        head.changed |= 1u << i;
+        values[count++] = step.registers.x[i];
+      }
+    }
+    if (step.registers.sp != previous.sp) {
+      head.changed |= spBit;
+      values[count++] = step.registers.sp;
+    }
+    if (fwrite(&head, sizeof(head), 1, file) != 1 || fwrite(values, sizeof(uint64_t), count, file) != size_t(count)) {
+      return false;
+    }
+    written += sizeof(head) + count * sizeof(uint64_t);
+  }
+  previous = step.registers;
+  steps++;
+  return true;
+}
+
+// Function to patch the step count into the header and close the file
+bool ExecutionTraceWriter::close() {
+  if (!file) {
+    return false;
+  }
+  bool ok = fileHeader.version == traceVersion;  // begin() was reached
+  if (ok) {
+    fileHeader.stepCount = steps;
+    ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&fileHeader, sizeof(fileHeader), 1, file) == 1;
+  }
+  ok = fclose(file) == 0 && ok;
+  file = nullptr;
+  return ok;
+}
+
+ExecutionTraceReader::~ExecutionTraceReader() {
+  close();
+}
+
+void ExecutionTraceReader::close() {
+  if (data) {
+    munmap(const_cast<uint8_t*>(data), size);
+  }
+  data = nullptr;
+  fileHeader = nullptr;
+  size = 0;
+}
+
+// Function to map and validate a trace file
+bool ExecutionTraceReader::open(const string& path) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    cerr << "Error: Unable to open trace file " << path << endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(TraceFileHeader)) {
+    cerr << "Error: Trace file " << path << " is too short" << endl;
+    ::close(fd);
+    return false;
+  }
+  void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    cerr << "Error: Unable to map trace file " << path << endl;
+    return false;
+  }
+  data = static_cast<const uint8_t*>(mapped);
+  size = st.st_size;
+  madvise(mapped, size, MADV_SEQUENTIAL);
+  fileHeader = reinterpret_cast<const TraceFileHeader*>(data);
+
+  if (memcmp(fileHeader->magic, traceMagic, sizeof(traceMagic)) != 0 || fileHeader->version != traceVersion ||
+      fileHeader->registerCount != 31 || fileHeader->mode > uint16_t(TraceMode::Destination)) {
+    cerr << "Error: " << path << " is not a Fides execution trace" << endl;
+    close();
+    return false;
+  }
+  offset = sizeof(TraceFileHeader);
+  stepIndex = 0;
+  current = fileHeader->initial;
+  return true;
+}
+
+// Function to decode the next step; returns false at the end or on a corrupt record
+bool ExecutionTraceReader::next(TraceStep& step) {
+  if (!data || stepIndex >= fileHeader->stepCount) {
+    return false;
+  }
+  if (fileHeader->mode == uint16_t(TraceMode::Snapshot)) {
+    if (size - offset < sizeof(SnapshotRecord)) {
+      cerr << "Error: Trace file is truncated at step " << stepIndex << endl;
+      return false;
+    }
+    SnapshotRecord record;
+    memcpy(&record, data + offset, sizeof(record));
+    offset += sizeof(record);
+    step.pc = record.pc;
+    step.instruction = record.instruction;
+    memcpy(current.x, record.x, sizeof(current.x));
+    current.sp = record.sp;
+  } else if (fileHeader->mode == uint16_t(TraceMode::Destination)) {
+    if (size - offset < sizeof(uint32_t)) {
+      cerr << "Error: Trace file is truncated at step " << stepIndex << endl;
+      return false;
+    }
+    memcpy(&step.instruction, data + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    uint32_t rd = destinationRegister(step.instruction);
+    if (rd != 31) {
+      if (size - offset < sizeof(uint64_t)) {
+        cerr << "Error: Trace file is truncated at step " << stepIndex << endl;
+        return false;
+      }
+      memcpy(&current.x[rd], data + offset, sizeof(uint64_t));
+      offset += sizeof(uint64_t);
+    }
+    step.pc = 0;
+    stepIndex++;
+    current.pc = stepIndex < fileHeader->stepCount ? 0 : fileHeader->zkpEnd;
+    step.registers = current;
+    return true;
+  } else {
+    DeltaRecordHead head;
+    if (size - offset < sizeof(head)) {
+      cerr << "Error: Trace file is truncated at step " << stepIndex << endl;
+      return false;
+    }
+    memcpy(&head, data + offset, sizeof(head));
+    offset += sizeof(head);
+    size_t count = __builtin_popcount(head.changed);
+    if (size - offset < count * sizeof(uint64_t)) {
+      cerr << "Error: Trace file is truncated at step " << stepIndex << endl;
+      return false;
+    }
+    const uint8_t* value = data + offset;
+    for (int i = 0; i < 31; i++) {
+      if (head.changed & (1u << i)) {
+        memcpy(&current.x[i], value, sizeof(uint64_t));
+        value += sizeof(uint64_t);
+      }
+    }
+    if (head.changed & spBit) {
+      memcpy(&current.sp, value, sizeof(uint64_t));
+    }
+    offset += count * sizeof(uint64_t);
+    step.pc = head.pc;
+    step.instruction = head.instruction;
+  }
+
+  // The resulting pc is where the next record starts, or zkp_end after the last one
+  stepIndex++;
+  current.pc = fileHeader->zkpEnd;
+  if (stepIndex < fileHeader->stepCount && size - offset >= sizeof(uint64_t)) {
+    memcpy(&current.pc, data + offset, sizeof(uint64_t));
+  }
+  step.registers = current;
+  return true;
+}
+
+// Function to write the trace as text in the layout of the gdb execution_trace.txt (debug only)
+bool ExecutionTraceReader::exportText(const string& path) {
+  if (!data) {
+    return false;
+  }
+  FILE* out = fopen(path.c_str(), "w");
+  if (!out) {
+    cerr << "Error: Unable to create " << path << endl;
+    return false;
+  }
+
+  // Replay from the start without disturbing an ongoing read
+  size_t savedOffset = offset;
+  uint64_t savedIndex = stepIndex;
+  RegisterSnapshot savedCurrent = current;
+  offset = sizeof(TraceFileHeader);
+  stepIndex = 0;
+  current = fileHeader->initial;
+
+  printRegisters(out, fileHeader->initial);
+  TraceStep step;
+  bool first = true;
+  while (next(step)) {
+    if (!first) {
+      fprintf(out, "-----------------------------------------------------\n");
+    }
+    first = false;
+    // No disassembler here: the raw encoding stands in for gdb's x/i output
+    fprintf(out, "=> 0x%llx:\t.inst\t0x%08x\n", (unsigned long long)step.pc, step.instruction);
+    printRegisters(out, step.registers);
+  }
+  bool complete = stepIndex == fileHeader->stepCount;
+
+  offset = savedOffset;
+  stepIndex = savedIndex;
+  current = savedCurrent;
+  return fclose(out) == 0 && complete;
+}
@@ -0,0 +1,183 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef EXECUTION_TRACE_H
+#define EXECUTION_TRACE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+using namespace std;
+
+// General purpose registers as seen by the traced program
+struct RegisterSnapshot {
+  uint64_t x[31];
+  uint64_t sp;
+  uint64_t pc;
+};
+
+// One retired instruction: where it was, its encoding and the registers after it
+struct TraceStep {
+  uint64_t pc;
+  uint32_t instruction;
+  RegisterSnapshot registers;
+};
+
+// Function to get the general purpose register an AArch64 instruction writes
+// through Rd/Rt (bits 4:0). Returns 31 for xzr/sp and for instructions that
+// write none of x0..x30: stores, branches, system and SIMD&FP instructions.
+inline uint32_t destinationRegister(uint32_t instruction) {
+  uint32_t rd = instruction & 0x1f;
+  if ((instruction & 0x1c000000) == 0x10000000 || (instruction & 0x0e000000) == 0x0a000000) {
+    // Data processing, immediate or register; cmp, cmn and tst write xzr
+    return rd;
+  }
+  if ((instruction & 0x0e000000) != 0x08000000) {
+    return 31;
+  }
+  // Loads and stores of general purpose registers; only loads write Rt
+  bool load;
+  uint32_t group = (instruction >> 27) & 0x7;
+  uint32_t opc = (instruction >> 22) & 0x3;
+  if (group == 0x3) {
+    load = (instruction >> 30) != 0x3;                       // load literal, except prfm
+  } else if (group == 0x7) {
+    load = opc != 0 && !((instruction >> 30) == 0x3 && opc == 0x2);   // opc 00 stores, size 11 opc 10 is prfm
+  } else {
+    load = (instruction >> 22) & 1;                          // pairs and exclusives: the L bit
+  }
+  return load ? rd : 31;
+}
+
+// Binary execution trace (little-endian, as written by the host):
+//
+//   TraceFileHeader                       fixed size, stepCount patched on close
+//   step records, one per instruction:
+//     Snapshot mode: pc u64, instruction u32, reserved u32, x0..x30 u64, sp u64
+//     Delta mode:    pc u64, instruction u32, changed mask u32 (bit i = x_i,
+//                    bit 31 = sp), then one u64 per set bit in register order
+//     Destination:   instruction u32, then the u64 value of its destination
+//                    register unless destinationRegister() is 31 (xzr/sp, or
+//                    no register written); records are packed
+//
+// The registers after the last step have pc == zkpEnd; every other step's
+// resulting pc is the next record's pc, so it is not stored.
+//
+// Destination mode keeps only what the witness needs (12 bytes per step
+// against 272 for a snapshot). It stores no pc, so replayed steps report
+// pc 0, and registers written other than through Rd (the second register of
+// ldp, base write-back) keep their previous value in the replay.
+enum class TraceMode : uint16_t {
+  Snapshot = 0,
+  Delta = 1,
+  Destination = 2
+};
+
+struct TraceFileHeader {
+  char magic[4];            // "FZTR"
+  uint16_t version;
+  uint16_t mode;            // TraceMode
+  uint32_t registerCount;   // 31
+  uint32_t reserved;
+  uint64_t stepCount;
+  uint64_t zkpStart;
+  uint64_t zkpEnd;
+  RegisterSnapshot initial;
+};
+
+// Receives the code block while it is being traced
+class TraceSink {
+public:
+  virtual ~TraceSink() {}
+
+  // Function called once zkp_start is reached, with the registers the code block starts from
+  virtual bool begin(const RegisterSnapshot& initial, uint64_t zkpStart, uint64_t zkpEnd) = 0;
+
+  // Function called for every retired instruction; returning false stops the trace
+  virtual bool append(const TraceStep& step) = 0;
+};
+
+// Receives every captured execution when several regions, or repeated runs of
+// one region, are traced in a single run of the program
+class CaptureSink {
+public:
+  virtual ~CaptureSink() {}
+
+  // Function to get the sink for one execution of a region; nullptr stops tracing
+  virtual TraceSink* beginCapture(size_t region, uint64_t execution) = 0;
+
+  // Function called once that execution has reached the region's end label
+  virtual bool endCapture(size_t region, uint64_t execution, TraceSink* sink) = 0;
+};
+
+// Streams steps into a binary trace file
+class ExecutionTraceWriter : public TraceSink {
+public:
+  ~ExecutionTraceWriter();
+
+  // Function to create the trace file
+  bool open(const string& path, TraceMode mode);
+
+  // Function to write the header once the code block has been reached
+  bool begin(const RegisterSnapshot& initial, uint64_t zkpStart, uint64_t zkpEnd) override;
+
+  // Function to append one retired instruction
+  bool append(const TraceStep& step) override;
+
+  // Function to patch the step count into the header and close the file
+  bool close();
+
+  // Function to get the number of bytes written so far
+  uint64_t bytesWritten() const { return written; }
+
+private:
+  FILE* file = nullptr;
+  TraceMode mode = TraceMode::Delta;
+  TraceFileHeader fileHeader = {};
+  RegisterSnapshot previous = {};
+  uint64_t steps = 0;
+  uint64_t written = 0;
+};
+
+// Memory-maps a binary trace and replays it step by step with full register state
+class ExecutionTraceReader {
+public:
+  ~ExecutionTraceReader();
+
+  // Function to map and validate a trace file
+  bool open(const string& path);
+
+  const TraceFileHeader& header() const { return *fileHeader; }
+
+  // Function to decode the next step; returns false at the end or on a corrupt record
+  bool next(TraceStep& step);
+
+  // Function to write the trace as text in the layout of the gdb execution_trace.txt (debug only)
+  bool exportText(const string& path);
+
+private:
+  void close();
+
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  const TraceFileHeader* fileHeader = nullptr;
+  size_t offset = 0;
+  uint64_t stepIndex = 0;
+  RegisterSnapshot current = {};
+};
+
+#endif  // EXECUTION_TRACE_H
@@ -0,0 +1,535 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "nativeTracer.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <sys/uio.h>
+#if defined(__aarch64__)
+#include <asm/ptrace.h>
+#else
+#include <sys/user.h>
+#endif
+
+namespace {
+
+#if defined(__aarch64__)
+typedef struct user_pt_regs MachineRegisters;
+const uint64_t breakpointInstruction = 0xd4200000;  // brk #0, pc stays on it
+const uint64_t breakpointMask = 0xffffffff;
+const uint64_t breakpointLength = 0;
+#else
+// Lets the tracer run on an x86-64 development machine; the register
+// numbering there means nothing to the witness.
+typedef struct user_regs_struct MachineRegisters;
+const uint64_t breakpointInstruction = 0xcc;  // int3, pc moves past it
+const uint64_t breakpointMask = 0xff;
+const uint64_t breakpointLength = 1;
+#endif
+
+// Step budget so a code block that never reaches zkp_end cannot hang the prover
+const uint64_t maxSteps = 100000000;
+
+struct LoadSegment {
+  uint64_t address;
+  uint64_t offset;
+  uint64_t fileSize;
+};
+
+struct ElfInfo {
+  bool positionIndependent = false;
+  uint64_t firstLoadAddress = 0;  // p_vaddr of the lowest PT_LOAD segment
+  uint64_t firstCodeAddress = 0;  // p_vaddr of the lowest executable PT_LOAD segment
+  vector<LoadSegment> segments;   // PT_LOAD segments, to find code in the file
+};
+
+// Function to read the symbol addresses and load layout of an ELF file
+bool readElf(const string& elfPath, const vector<string>& names, vector<uint64_t>& addresses, ElfInfo& info) {
+  int fd = open(elfPath.c_str(), O_RDONLY);
+  if (fd == -1) {
+    cerr << "Error: Unable to open " << elfPath << endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(Elf64_Ehdr)) {
+    close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  const uint8_t* image = static_cast<const uint8_t*>(mapped);
+  const Elf64_Ehdr* header = reinterpret_cast<const Elf64_Ehdr*>(image);
+
+  bool ok = memcmp(header->e_ident, ELFMAG, SELFMAG) == 0 && header->e_ident[EI_CLASS] == ELFCLASS64 &&
+            header->e_shoff + uint64_t(header->e_shnum) * sizeof(Elf64_Shdr) <= size &&
+            header->e_phoff + uint64_t(header->e_phnum) * sizeof(Elf64_Phdr) <= size;
+  if (!ok) {
+    cerr << "Error: " << elfPath << " is not a 64-bit ELF file" << endl;
+    munmap(mapped, size);
+    return false;
+  }
+
+  info.positionIndependent = header->e_type == ET_DYN;
+  const Elf64_Phdr* segments = reinterpret_cast<const Elf64_Phdr*>(image + header->e_phoff);
+  info.firstLoadAddress = UINT64_MAX;
+  info.firstCodeAddress = UINT64_MAX;
+  for (int i = 0; i < header->e_phnum; i++) {
+    if (segments[i].p_type != PT_LOAD) {
+      continue;
+    }
+    info.segments.push_back({ segments[i].p_vaddr, segments[i].p_offset, segments[i].p_filesz });
+    if (segments[i].p_vaddr < info.firstLoadAddress) {
+      info.firstLoadAddress = segments[i].p_vaddr;
+    }
+    if ((segments[i].p_flags & PF_X) && segments[i].p_vaddr < info.firstCodeAddress) {
+      info.firstCodeAddress = segments[i].p_vaddr;
+    }
+  }
+
+  addresses.assign(names.size(), 0);
+  vector<bool> found(names.size(), false);
+  const Elf64_Shdr* sections = reinterpret_cast<const Elf64_Shdr*>(image + header->e_shoff);
+  // Prefer the full symbol table; the dynamic one only has exported symbols
+  for (uint32_t wanted : {SHT_SYMTAB, SHT_DYNSYM}) {
+    for (int i = 0; i < header->e_shnum; i++) {
+      if (sections[i].sh_type != wanted || sections[i].sh_link >= header->e_shnum) {
+        continue;
+      }
+      const Elf64_Shdr& strings = sections[sections[i].sh_link];
+      if (sections[i].sh_offset + sections[i].sh_size > size || strings.sh_offset + strings.sh_size > size) {
+        continue;
+      }
+      const Elf64_Sym* symbols = reinterpret_cast<const Elf64_Sym*>(image + sections[i].sh_offset);
+      const char* stringTable = reinterpret_cast<const char*>(image + strings.sh_offset);
+      size_t count = sections[i].sh_size / sizeof(Elf64_Sym);
+      for (size_t s = 0; s < count; s++) {
+        if (symbols[s].st_name >= strings.sh_size) {
+          continue;
+        }
+        for (size_t k = 0; k < names.size(); k++) {
+          if (!found[k] && names[k] == stringTable + symbols[s].st_name && symbols[s].st_value != 0) {
+            addresses[k] = symbols[s].st_value;
+            found[k] = true;
+          }
+        }
+      }
+    }
+  }
+  munmap(mapped, size);
+
+  for (size_t k = 0; k < names.size(); k++) {
+    if (!found[k]) {
+      cerr << "Error: Symbol " << names[k] << " not found in " << elfPath << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Function to find where the kernel mapped the executable in the traced process
+bool loadBias(pid_t pid, const string& program, const ElfInfo& info, uint64_t& bias) {
+  bias = 0;
+  if (!info.positionIndependent) {
+    return true;
+  }
+  char resolved[PATH_MAX];
+  if (!realpath(program.c_str(), resolved)) {
+    return false;
+  }
+  std::ifstream maps("/proc/" + to_string(pid) + "/maps");
+  string line;
+  while (getline(maps, line)) {
+    std::istringstream fields(line);
+    string range, perms, offset, device, inode, path;
+    fields >> range >> perms >> offset >> device >> inode >> path;
+    if (path == resolved && std::stoull(offset, nullptr, 16) == 0) {
+      bias = std::stoull(range.substr(0, range.find('-')), nullptr, 16) - (info.firstLoadAddress & ~uint64_t(0xfff));
+      return true;
+    }
+  }
+  cerr << "Error: Unable to find " << resolved << " in the traced process" << endl;
+  return false;
+}
+
+bool readRegisters(pid_t pid, RegisterSnapshot& snapshot) {
+  MachineRegisters regs;
+  struct iovec io = { &regs, sizeof(regs) };
+  if (ptrace(PTRACE_GETREGSET, pid, (void*)NT_PRSTATUS, &io) == -1) {
+    return false;
+  }
+#if defined(__aarch64__)
+  memcpy(snapshot.x, regs.regs, sizeof(snapshot.x));
+  snapshot.sp = regs.sp;
+  snapshot.pc = regs.pc;
+#else
+  const uint64_t general[] = { regs.rax, regs.rbx, regs.rcx, regs.rdx, regs.rsi, regs.rdi, regs.rbp, regs.r8,
+                               regs.r9, regs.r10, regs.r11, regs.r12, regs.r13, regs.r14, regs.r15 };
+  memset(snapshot.x, 0, sizeof(snapshot.x));
+  memcpy(snapshot.x, general, sizeof(general));
+  snapshot.sp = regs.rsp;
+  snapshot.pc = regs.rip;
+#endif
+  return true;
+}
+
+bool rewindPc(pid_t pid, uint64_t pc) {
+  MachineRegisters regs;
+  struct iovec io = { &regs, sizeof(regs) };
+  if (ptrace(PTRACE_GETREGSET, pid, (void*)NT_PRSTATUS, &io) == -1) {
+    return false;
+  }
+#if defined(__aarch64__)
+  regs.pc = pc;
+#else
+  regs.rip = pc;
+#endif
+  return ptrace(PTRACE_SETREGSET, pid, (void*)NT_PRSTATUS, &io) != -1;
+}
+
+// Function to wait for the next SIGTRAP stop; false if the program stopped for anything else
+bool waitForTrap(pid_t pid) {
+  int status;
+  if (waitpid(pid, &status, 0) == -1) {
+    return false;
+  }
+  if (WIFEXITED(status) || WIFSIGNALED(status)) {
+    cerr << "Error: Traced program exited before zkp_end" << endl;
+    return false;
+  }
+  if (WIFSTOPPED(status) && WSTOPSIG(status) != SIGTRAP) {
+    cerr << "Error: Traced program stopped by signal " << WSTOPSIG(status) << endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// Function to look up a symbol's address in the ELF symbol table
+bool NativeTracer::findSymbol(const string& elfPath, const string& name, uint64_t& address) {
+  vector<uint64_t> addresses;
+  ElfInfo info;
+  if (!readElf(elfPath, { name }, addresses, info)) {
+    return false;
+  }
+  address = addresses[0];
+  return true;
+}
+
+// Function to read the link-time address of the lowest executable PT_LOAD segment
+bool NativeTracer::findCodeStart(const string& elfPath, uint64_t& address) {
+  vector<uint64_t> addresses;
+  ElfInfo info;
+  if (!readElf(elfPath, {}, addresses, info) || info.firstCodeAddress == UINT64_MAX) {
+    return false;
+  }
+  address = info.firstCodeAddress;
+  return true;
+}
+
+namespace {
+
+// Records into the tracer's own step list, or forwards to the caller's sink
+class SingleCapture : public CaptureSink {
+public:
+  SingleCapture(TraceSink* sink, vector<TraceStep>& steps) : sink(sink), recorder(steps) {}
+
+  TraceSink* beginCapture(size_t region, uint64_t execution) override {
+    (void)region;
+    (void)execution;
+    return sink ? sink : &recorder;
+  }
+
+  bool endCapture(size_t region, uint64_t execution, TraceSink* capture) override {
+    (void)region;
+    (void)execution;
+    (void)capture;
+    return true;
+  }
+
+private:
+  class Recorder : public TraceSink {
+  public:
+    explicit Recorder(vector<TraceStep>& steps) : steps(steps) {}
+    bool begin(const RegisterSnapshot&, uint64_t, uint64_t) override { return true; }
+    bool append(const TraceStep& step) override {
+      steps.push_back(step);
+      return true;
+    }
+  private:
+    vector<TraceStep>& steps;
+  };
+
+  TraceSink* sink;
+  Recorder recorder;
+};
+
+// Function to read the program counter of a stopped tracee
+bool readPc(pid_t pid, uint64_t& pc) {
+  RegisterSnapshot registers;
+  if (!readRegisters(pid, registers)) {
+    return false;
+  }
+  pc = registers.pc;
+  return true;
+}
+
+// Function to write or remove the breakpoints at the region starts
+bool setBreakpoints(pid_t pid, const vector<uint64_t>& addresses, const vector<long>& originals, bool armed) {
+  for (size_t i = 0; i < addresses.size(); i++) {
+    long word = armed ? ((originals[i] & ~long(breakpointMask)) | long(breakpointInstruction)) : originals[i];
+    if (ptrace(PTRACE_POKETEXT, pid, (void*)addresses[i], (void*)word) == -1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// Function to read the instruction words from one symbol up to (not including) another
+bool NativeTracer::readCodeBlock(const string& elfPath, const string& startSymbol, const string& endSymbol,
+                                 uint64_t& startAddress, vector<uint32_t>& words) {
+  vector<uint64_t> addresses;
+  ElfInfo info;
+  if (!readElf(elfPath, { startSymbol, endSymbol }, addresses, info)) {
+    return false;
+  }
+  startAddress = addresses[0];
+  uint64_t endAddress = addresses[1];
+  if (endAddress < startAddress || (endAddress - startAddress) % 4 != 0) {
+    cerr << "Error: " << startSymbol << " and " << endSymbol << " do not delimit a code block" << endl;
+    return false;
+  }
+  for (const LoadSegment& segment : info.segments) {
+    if (startAddress >= segment.address && endAddress <= segment.address + segment.fileSize) {
+      words.resize((endAddress - startAddress) / 4);
+      std::ifstream file(elfPath, std::ios::binary);
+      file.seekg(segment.offset + (startAddress - segment.address));
+      file.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(uint32_t));
+      return bool(file) || words.empty();
+    }
+  }
+  cerr << "Error: " << startSymbol << " is not in a loadable segment of " << elfPath << endl;
+  return false;
+}
+
+// Function to run the program and record the code block; returns false on failure
+bool NativeTracer::trace(const string& program, TraceSink* sink) {
+  recordedSteps.clear();
+  SingleCapture single(sink, recordedSteps);
+  if (!traceRegions(program, { { "zkp_start", "zkp_end" } }, single, 1)) {
+    return false;
+  }
+  if (captures == 0) {
+    cerr << "Error: Traced program exited before zkp_start" << endl;
+    return false;
+  }
+  return true;
+}
+
+// Function to run the program once and capture every execution of the regions
+bool NativeTracer::traceRegions(const string& program, const vector<TraceRegion>& regions, CaptureSink& sink,
+                                uint64_t maxCaptures) {
+  executedSteps = 0;
+  captures = 0;
+  seconds = 0;
+
+  vector<string> names;
+  for (const TraceRegion& region : regions) {
+    names.push_back(region.startSymbol);
+    names.push_back(region.endSymbol);
+  }
+  vector<uint64_t> symbols;
+  ElfInfo info;
+  if (regions.empty() || !readElf(program, names, symbols, info)) {
+    return false;
+  }
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    cerr << "Error: fork failed: " << strerror(errno) << endl;
+    return false;
+  }
+  if (pid == 0) {
+    // Keep the program's own output out of the way, as the gdb script did
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull != -1) {
+      dup2(devNull, STDOUT_FILENO);
+      dup2(devNull, STDERR_FILENO);
+    }
+    ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+    execl(program.c_str(), program.c_str(), (char*)nullptr);
+    _exit(127);
+  }
+
+  bool ok = false;
+  bool exited = false;
+  do {
+    // The child stops with SIGTRAP right after exec
+    if (!waitForTrap(pid)) break;
+    ptrace(PTRACE_SETOPTIONS, pid, nullptr, (void*)PTRACE_O_EXITKILL);
+
+    uint64_t bias;
+    if (!loadBias(pid, program, info, bias)) break;
+    vector<uint64_t> starts, ends;
+    for (size_t r = 0; r < regions.size(); r++) {
+      starts.push_back(symbols[2 * r] + bias);
+      ends.push_back(symbols[2 * r + 1] + bias);
+    }
+
+    // Run at full speed between captures behind breakpoints on every region start
+    vector<long> originals;
+    bool readable = true;
+    for (uint64_t start : starts) {
+      errno = 0;
+      originals.push_back(ptrace(PTRACE_PEEKTEXT, pid, (void*)start, nullptr));
+      readable = readable && errno == 0;
+    }
+    if (!readable || !setBreakpoints(pid, starts, originals, true)) break;
+
+    vector<uint64_t> executions(regions.size(), 0);
+    bool failed = false;
+    int pendingSignal = 0;
+    while (captures < maxCaptures) {
+      if (ptrace(PTRACE_CONT, pid, nullptr, (void*)(long)pendingSignal) == -1) {
+        failed = true;
+        break;
+      }
+      pendingSignal = 0;
+      int status;
+      if (waitpid(pid, &status, 0) == -1) {
+        failed = true;
+        break;
+      }
+      if (WIFEXITED(status) || WIFSIGNALED(status)) {
+        exited = true;
+        break;
+      }
+      if (WIFSTOPPED(status) && WSTOPSIG(status) != SIGTRAP) {
+        // Not ours: hand the signal to the program
+        pendingSignal = WSTOPSIG(status);
+        continue;
+      }
+
+      uint64_t pc;
+      if (!readPc(pid, pc)) {
+        failed = true;
+        break;
+      }
+      size_t region = 0;
+      while (region < starts.size() && starts[region] != pc - breakpointLength) {
+        region++;
+      }
+      if (region == starts.size()) {
+        cerr << "Error: Unexpected trap at 0x" << hex << pc << dec << endl;
+        failed = true;
+        break;
+      }
+      if (!setBreakpoints(pid, starts, originals, false)) {
+        failed = true;
+        break;
+      }
+      if (breakpointLength != 0 && !rewindPc(pid, starts[region])) {
+        failed = true;
+        break;
+      }
+
+      TraceSink* capture = sink.beginCapture(region, executions[region]);
+      if (!capture) {
+        break;  // the caller has enough
+      }
+      auto startTime = chrono::steady_clock::now();
+
+      // Step over the nop at the start label, then snapshot the registers the code block starts from
+      if (ptrace(PTRACE_SINGLESTEP, pid, nullptr, nullptr) == -1 || !waitForTrap(pid) ||
+          !readRegisters(pid, initial) || !capture->begin(initial, starts[region], ends[region])) {
+        failed = true;
+        break;
+      }
+
+      uint64_t current = initial.pc;
+      uint64_t regionSteps = 0;
+      while (current != ends[region]) {
+        if (regionSteps >= maxSteps) {
+          cerr << "Error: " << regions[region].endSymbol << " not reached after " << maxSteps << " instructions" << endl;
+          failed = true;
+          break;
+        }
+        TraceStep step;
+        step.pc = current;
+        errno = 0;
+        step.instruction = uint32_t(ptrace(PTRACE_PEEKTEXT, pid, (void*)current, nullptr));
+        if (errno != 0 || ptrace(PTRACE_SINGLESTEP, pid, nullptr, nullptr) == -1 || !waitForTrap(pid) ||
+            !readRegisters(pid, step.registers) || !capture->append(step)) {
+          failed = true;
+          break;
+        }
+        current = step.registers.pc;
+        regionSteps++;
+        executedSteps++;
+      }
+      seconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+      if (failed || !sink.endCapture(region, executions[region], capture)) {
+        failed = true;
+        break;
+      }
+      executions[region]++;
+      captures++;
+
+      if (captures < maxCaptures && !setBreakpoints(pid, starts, originals, true)) {
+        failed = true;
+        break;
+      }
+    }
+    ok = !failed;
+  } while (false);
+
+  if (exited) {
+    return ok;  // the program finished on its own, nothing left to reap
+  }
+  if (ok) {
+    // Let the rest of the program run untraced
+    ptrace(PTRACE_DETACH, pid, nullptr, nullptr);
+  } else {
+    kill(pid, SIGKILL);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+  return ok;
+}
+
+// Function to get the single-stepping throughput of the last trace
+double NativeTracer::instructionsPerSecond() const {
+  return seconds > 0 ? executedSteps / seconds : 0;
+}
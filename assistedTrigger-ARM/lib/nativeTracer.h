@@ -0,0 +1,80 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NATIVE_TRACER_H
+#define NATIVE_TRACER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "executionTrace.h"
+
+using namespace std;
+
+// A code block delimited by a pair of labels inserted by the commitmentGenerator
+struct TraceRegion {
+  string startSymbol;
+  string endSymbol;
+};
+
+// In-process replacement for the gdb script: runs the program under ptrace,
+// stops at zkp_start and single-steps until zkp_end, keeping every step in memory.
+class NativeTracer {
+public:
+  // Function to look up a symbol's address in the ELF symbol table
+  static bool findSymbol(const string& elfPath, const string& name, uint64_t& address);
+
+  // Function to read the link-time address of the lowest executable PT_LOAD
+  // segment, which is where qemu_plugin_entry_code() points at run time
+  static bool findCodeStart(const string& elfPath, uint64_t& address);
+
+  // Function to read the instruction words from one symbol up to (not including) another
+  static bool readCodeBlock(const string& elfPath, const string& startSymbol, const string& endSymbol,
+                            uint64_t& startAddress, vector<uint32_t>& words);
+
+  // Function to run the program and record the code block; returns false on failure.
+  // With a sink (trace file, witness stream) the steps go there instead of memory.
+  bool trace(const string& program, TraceSink* sink = nullptr);
+
+  // Function to run the program once and capture every execution of the regions,
+  // up to maxCaptures in total, each into the sink handed out by captureSink.
+  // Returns false on failure; the program may exit before maxCaptures is reached.
+  bool traceRegions(const string& program, const vector<TraceRegion>& regions, CaptureSink& captureSink,
+                    uint64_t maxCaptures);
+
+  // Registers before the first instruction of the (last captured) code block
+  const RegisterSnapshot& initialRegisters() const { return initial; }
+
+  // Every instruction executed between zkp_start and zkp_end (empty when tracing to a sink)
+  const vector<TraceStep>& steps() const { return recordedSteps; }
+
+  // Function to get the number of instructions executed in the code block(s)
+  uint64_t stepCount() const { return executedSteps; }
+
+  // Function to get the number of region executions captured by the last trace
+  uint64_t captureCount() const { return captures; }
+
+  // Function to get the single-stepping throughput of the last trace
+  double instructionsPerSecond() const;
+
+private:
+  RegisterSnapshot initial = {};
+  vector<TraceStep> recordedSteps;
+  uint64_t executedSteps = 0;
+  uint64_t captures = 0;
+  double seconds = 0;
+};
+
+#endif  // NATIVE_TRACER_H
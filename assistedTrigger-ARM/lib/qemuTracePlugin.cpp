@@ -0,0 +1,284 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// QEMU user-mode TCG plugin that traces the code block between zkp_start and
+// zkp_end of an aarch64 program and writes the same execution_trace.bin as
+// the native tracer, so aarch64 programs can be traced on x86 hosts.
+//
+// Needs QEMU 9.1 or newer (register read API). See the README for the build
+// line; it is loaded with
+//   qemu-aarch64 -plugin ./libfidesTrace.so,trace=execution_trace.bin,start=0x..,end=0x..,code=0x.. ./program
+// where start, end and code are the link-time addresses of zkp_start, zkp_end
+// and the lowest executable PT_LOAD segment. Optional: mode=destination|delta|snapshot.
+
+#include <glib.h>
+extern "C" {
+#include <qemu-plugin.h>
+}
+#include "executionTrace.h"
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <cstring>
+#include <cstdlib>
+
+extern "C" {
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+}
+
+namespace {
+
+// Step budget so a code block that never reaches zkp_end cannot fill the disk
+const uint64_t maxSteps = 100000000;
+
+struct InstructionInfo {
+  uint64_t vaddr;
+  uint32_t encoding;
+};
+
+enum class TraceState {
+  Waiting,   // zkp_start not reached yet
+  AtStart,   // the nop at zkp_start is executing
+  Tracing,   // inside the code block
+  Done,      // zkp_end reached and the trace file closed
+  Failed
+};
+
+struct Plugin {
+  string path = "execution_trace.bin";
+  TraceMode mode = TraceMode::Destination;
+  uint64_t linkStart = 0, linkEnd = 0, linkCode = 0;
+  uint64_t start = 0, end = 0;  // run-time addresses
+  once_flag relocated;
+
+  mutex translationLock;
+  unordered_map<uint64_t, InstructionInfo> instructions;
+
+  // Only the vCPU that reached zkp_start first is traced
+  atomic<int> owner{-1};
+  atomic<TraceState> state{TraceState::Waiting};
+
+  struct qemu_plugin_register* x[31] = {};
+  struct qemu_plugin_register* sp = nullptr;
+  GByteArray* buffer = nullptr;
+
+  ExecutionTraceWriter writer;
+  TraceStep pending = {};
+  uint64_t steps = 0;
+};
+
+Plugin plugin;
+
+uint64_t readRegister(struct qemu_plugin_register* handle) {
+  uint64_t value = 0;
+  g_byte_array_set_size(plugin.buffer, 0);
+  int size = qemu_plugin_read_register(handle, plugin.buffer);
+  if (size > 0) {
+    memcpy(&value, plugin.buffer->data, size < 8 ? size : 8);
+  }
+  return value;
+}
+
+void readAllRegisters(RegisterSnapshot& registers) {
+  for (int i = 0; i < 31; i++) {
+    registers.x[i] = readRegister(plugin.x[i]);
+  }
+  registers.sp = readRegister(plugin.sp);
+}
+
+// Function to fill in the registers the finished instruction produced. The
+// destination-only trace needs just Rd, which saves 32 register reads per step.
+void readRetiredRegisters(TraceStep& step) {
+  if (plugin.mode == TraceMode::Destination) {
+    uint32_t rd = destinationRegister(step.instruction);
+    if (rd != 31) {
+      step.registers.x[rd] = readRegister(plugin.x[rd]);
+    }
+  } else {
+    readAllRegisters(step.registers);
+  }
+}
+
+void fail(const char* message) {
+  cerr << "Error: Fides trace plugin: " << message << endl;
+  plugin.state = TraceState::Failed;
+  plugin.writer.close();
+  remove(plugin.path.c_str());
+}
+
+// Called before every guest instruction; the registers read here are the
+// result of the previous instruction
+void onExecute(unsigned int vcpu, void* userdata) {
+  const InstructionInfo* instruction = static_cast<const InstructionInfo*>(userdata);
+  TraceState state = plugin.state.load(memory_order_acquire);
+  if (state == TraceState::Done || state == TraceState::Failed) {
+    return;
+  }
+  if (state == TraceState::Waiting) {
+    int expected = -1;
+    if (instruction->vaddr != plugin.start || !plugin.owner.compare_exchange_strong(expected, int(vcpu))) {
+      return;
+    }
+    plugin.state.store(TraceState::AtStart, memory_order_release);
+    return;
+  }
+  if (plugin.owner.load(memory_order_relaxed) != int(vcpu)) {
+    return;
+  }
+
+  if (state == TraceState::AtStart) {
+    // The nop at zkp_start has run: these are the registers the code block starts from
+    RegisterSnapshot initial = {};
+    readAllRegisters(initial);
+    initial.pc = instruction->vaddr;
+    if (!plugin.writer.begin(initial, plugin.start, plugin.end)) {
+      fail("unable to write the trace header");
+      return;
+    }
+    plugin.pending.registers = initial;
+    plugin.state.store(TraceState::Tracing, memory_order_release);
+  } else {
+    readRetiredRegisters(plugin.pending);
+    plugin.pending.registers.pc = instruction->vaddr;
+    if (!plugin.writer.append(plugin.pending)) {
+      fail("unable to write the trace");
+      return;
+    }
+    if (++plugin.steps >= maxSteps) {
+      fail("zkp_end not reached within the step budget");
+      return;
+    }
+  }
+
+  if (instruction->vaddr == plugin.end) {
+    if (!plugin.writer.close()) {
+      fail("unable to finish the trace file");
+      return;
+    }
+    plugin.state.store(TraceState::Done, memory_order_release);
+    return;
+  }
+  plugin.pending.pc = instruction->vaddr;
+  plugin.pending.instruction = instruction->encoding;
+}
+
+void onTranslate(qemu_plugin_id_t id, struct qemu_plugin_tb* tb) {
+  (void)id;
+  // The guest is loaded by now, so the PIE load bias is known.
+  // qemu_plugin_entry_code() is the run-time start of the lowest executable
+  // segment (not e_entry), so it is matched against that segment's p_vaddr.
+  call_once(plugin.relocated, [] {
+    uint64_t bias = qemu_plugin_entry_code() - plugin.linkCode;
+    plugin.start = plugin.linkStart + bias;
+    plugin.end = plugin.linkEnd + bias;
+  });
+
+  lock_guard<mutex> guard(plugin.translationLock);
+  size_t count = qemu_plugin_tb_n_insns(tb);
+  for (size_t i = 0; i < count; i++) {
+    struct qemu_plugin_insn* insn = qemu_plugin_tb_get_insn(tb, i);
+    uint64_t vaddr = qemu_plugin_insn_vaddr(insn);
+    InstructionInfo& info = plugin.instructions[vaddr];
+    info.vaddr = vaddr;
+    info.encoding = 0;
+    qemu_plugin_insn_data(insn, &info.encoding, sizeof(info.encoding));
+    qemu_plugin_register_vcpu_insn_exec_cb(insn, onExecute, QEMU_PLUGIN_CB_R_REGS, &info);
+  }
+}
+
+void onVcpuInit(qemu_plugin_id_t id, unsigned int vcpu) {
+  (void)id;
+  (void)vcpu;
+  if (plugin.sp) {
+    return;  // every vCPU shares the same register layout
+  }
+  GArray* registers = qemu_plugin_get_registers();
+  for (guint i = 0; i < registers->len; i++) {
+    qemu_plugin_reg_descriptor* descriptor = &g_array_index(registers, qemu_plugin_reg_descriptor, i);
+    const char* name = descriptor->name;
+    if (strcmp(name, "sp") == 0) {
+      plugin.sp = descriptor->handle;
+    } else if (name[0] == 'x' && name[1] >= '0' && name[1] <= '9') {
+      int index = atoi(name + 1);
+      if (index >= 0 && index < 31) {
+        plugin.x[index] = descriptor->handle;
+      }
+    }
+  }
+  g_array_free(registers, TRUE);
+}
+
+void onExit(qemu_plugin_id_t id, void* userdata) {
+  (void)id;
+  (void)userdata;
+  if (plugin.state.load() != TraceState::Done && plugin.state.load() != TraceState::Failed) {
+    fail("program exited before zkp_end");
+  }
+}
+
+bool parseAddress(const char* text, uint64_t& value) {
+  char* endPointer = nullptr;
+  value = strtoull(text, &endPointer, 0);
+  return endPointer != text && *endPointer == '\0';
+}
+
+}  // namespace
+
+extern "C" QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t* info, int argc, char** argv) {
+  if (strcmp(info->target_name, "aarch64") != 0) {
+    cerr << "Error: Fides trace plugin only supports aarch64 guests" << endl;
+    return -1;
+  }
+
+  bool haveStart = false, haveEnd = false, haveCode = false;
+  for (int i = 0; i < argc; i++) {
+    string option = argv[i];
+    size_t equals = option.find('=');
+    string key = option.substr(0, equals);
+    string value = equals == string::npos ? "" : option.substr(equals + 1);
+    if (key == "trace") {
+      plugin.path = value;
+    } else if (key == "start") {
+      haveStart = parseAddress(value.c_str(), plugin.linkStart);
+    } else if (key == "end") {
+      haveEnd = parseAddress(value.c_str(), plugin.linkEnd);
+    } else if (key == "code") {
+      haveCode = parseAddress(value.c_str(), plugin.linkCode);
+    } else if (key == "mode" && value == "destination") {
+      plugin.mode = TraceMode::Destination;
+    } else if (key == "mode" && value == "delta") {
+      plugin.mode = TraceMode::Delta;
+    } else if (key == "mode" && value == "snapshot") {
+      plugin.mode = TraceMode::Snapshot;
+    } else {
+      cerr << "Error: Fides trace plugin: unknown option " << option << endl;
+      return -1;
+    }
+  }
+  if (!haveStart || !haveEnd || !haveCode) {
+    cerr << "Error: Fides trace plugin needs start=, end= and code= addresses" << endl;
+    return -1;
+  }
+  if (!plugin.writer.open(plugin.path, plugin.mode)) {
+    return -1;
+  }
+  plugin.buffer = g_byte_array_new();
+
+  qemu_plugin_register_vcpu_init_cb(id, onVcpuInit);
+  qemu_plugin_register_vcpu_tb_trans_cb(id, onTranslate);
+  qemu_plugin_register_atexit_cb(id, onExit, nullptr);
+  return 0;
+}
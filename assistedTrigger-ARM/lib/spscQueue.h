@@ -0,0 +1,78 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+using namespace std;
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// The capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue {
+public:
+  explicit SpscQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    slots.resize(size);
+    mask = size - 1;
+  }
+
+  // Function to add an item (producer only); returns false when the queue is full
+  bool push(const T& item) {
+    size_t tail = tailIndex.load(memory_order_relaxed);
+    if (tail - headCache > mask) {
+      headCache = headIndex.load(memory_order_acquire);
+      if (tail - headCache > mask) {
+        return false;
+      }
+    }
+    slots[tail & mask] = item;
+    tailIndex.store(tail + 1, memory_order_release);
+    return true;
+  }
+
+  // Function to remove the oldest item (consumer only); returns false when the queue is empty
+  bool pop(T& item) {
+    size_t head = headIndex.load(memory_order_relaxed);
+    if (head == tailCache) {
+      tailCache = tailIndex.load(memory_order_acquire);
+      if (head == tailCache) {
+        return false;
+      }
+    }
+    item = slots[head & mask];
+    headIndex.store(head + 1, memory_order_release);
+    return true;
+  }
+
+private:
+  vector<T> slots;
+  size_t mask;
+  // Producer and consumer indices live on separate cache lines, each next to
+  // the owner's cached copy of the other side's index
+  alignas(64) atomic<size_t> tailIndex{0};
+  size_t headCache = 0;
+  alignas(64) atomic<size_t> headIndex{0};
+  size_t tailCache = 0;
+};
+
+#endif  // SPSC_QUEUE_H
@@ -0,0 +1,113 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "witnessStream.h"
+#include <chrono>
+
+WitnessStream::WitnessStream(vector<int64_t>& z, size_t capacity)
+  : z(z), queue(capacity) {
+}
+
+WitnessStream::~WitnessStream() {
+  finish();
+}
+
+// Function to write the initial registers and start the builder thread
+bool WitnessStream::begin(const RegisterSnapshot& initial, uint64_t zkpStart, uint64_t zkpEnd) {
+  (void)zkpStart;
+  (void)zkpEnd;
+  z.push_back(1);
+  for (int i = 0; i < 31; i++) {
+    z.push_back(int64_t(initial.x[i]));
+  }
+  z.push_back(0);
+  // From here on only the builder thread touches z
+  builder = thread(&WitnessStream::worker, this);
+  return true;
+}
+
+// Function to queue the destination register value of one retired instruction
+bool WitnessStream::append(const TraceStep& step) {
+  uint32_t rd = destinationRegister(step.instruction);
+  if (rd == 31) {
+    return true;  // no register written, or xzr/sp: not part of the witness
+  }
+  Record record = { rd, step.registers.x[rd] };
+  while (!queue.push(record)) {
+    stalls++;
+    this_thread::yield();
+  }
+  return true;
+}
+
+// Function to wait until every queued value is in the witness
+void WitnessStream::finish() {
+  done.store(true, memory_order_release);
+  if (builder.joinable()) {
+    builder.join();
+  }
+}
+
+void WitnessStream::add(const Record& record) {
+  if (firstInstruction) {
+    input = z[record.rd + 1];
+    firstInstruction = false;
+  }
+  output = int64_t(record.value);
+  z.push_back(output);
+}
+
+void WitnessStream::worker() {
+  Record record;
+  int idle = 0;
+  while (true) {
+    // Read done first: once it is set, everything pushed before it is already visible
+    bool finished = done.load(memory_order_acquire);
+    if (queue.pop(record)) {
+      add(record);
+      idle = 0;
+      continue;
+    }
+    if (finished) {
+      return;
+    }
+    // Each single-step costs the tracer several system calls, so the queue is
+    // mostly empty; back off instead of spinning on a core the setup needs
+    if (++idle < 64) {
+      this_thread::yield();
+    } else {
+      this_thread::sleep_for(chrono::microseconds(50));
+    }
+  }
+}
+
+TraceSink* WitnessBatch::beginCapture(size_t region, uint64_t execution) {
+  results.push_back(WitnessCapture());
+  results.back().region = region;
+  results.back().execution = execution;
+  stream.reset(new WitnessStream(results.back().z));
+  return stream.get();
+}
+
+bool WitnessBatch::endCapture(size_t region, uint64_t execution, TraceSink* sink) {
+  (void)region;
+  (void)execution;
+  (void)sink;
+  stream->finish();
+  results.back().input = stream->inputValue();
+  results.back().output = stream->outputValue();
+  stream.reset();
+  return true;
+}
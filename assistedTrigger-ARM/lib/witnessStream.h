@@ -0,0 +1,102 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef WITNESS_STREAM_H
+#define WITNESS_STREAM_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <memory>
+#include <cstdint>
+#include "executionTrace.h"
+#include "spscQueue.h"
+
+using namespace std;
+
+// Builds z_array while the tracer is still running. The tracer thread pushes
+// each destination register value into an SPSC queue and a builder thread
+// appends it to the witness, so no trace is stored in between.
+//
+// z = [1, x0..x30 at zkp_start, 0, then the Rd value of every instruction
+// whose Rd is not 31], the same layout process_execution_trace_file produces.
+class WitnessStream : public TraceSink {
+public:
+  explicit WitnessStream(vector<int64_t>& z, size_t capacity = 4096);
+  ~WitnessStream();
+
+  // Function to write the initial registers and start the builder thread
+  bool begin(const RegisterSnapshot& initial, uint64_t zkpStart, uint64_t zkpEnd) override;
+
+  // Function to queue the destination register value of one retired instruction
+  bool append(const TraceStep& step) override;
+
+  // Function to wait until every queued value is in the witness
+  void finish();
+
+  // Value of the first instruction's destination register before it ran
+  int64_t inputValue() const { return input; }
+
+  // Value written by the last instruction
+  int64_t outputValue() const { return output; }
+
+  // Function to get how often the tracer found the queue full
+  uint64_t producerStalls() const { return stalls; }
+
+private:
+  struct Record {
+    uint32_t rd;
+    uint64_t value;
+  };
+
+  void add(const Record& record);
+  void worker();
+
+  vector<int64_t>& z;
+  SpscQueue<Record> queue;
+  thread builder;
+  atomic<bool> done{false};
+  bool firstInstruction = true;
+  int64_t input = 0;
+  int64_t output = 0;
+  uint64_t stalls = 0;
+};
+
+// One captured execution of a region and the witness built from it
+struct WitnessCapture {
+  size_t region;
+  uint64_t execution;
+  vector<int64_t> z;
+  int64_t input = 0;
+  int64_t output = 0;
+};
+
+// Builds a separate witness for every execution captured by NativeTracer::traceRegions
+class WitnessBatch : public CaptureSink {
+public:
+  TraceSink* beginCapture(size_t region, uint64_t execution) override;
+  bool endCapture(size_t region, uint64_t execution, TraceSink* sink) override;
+
+  // Captured witnesses in the order they were executed
+  const deque<WitnessCapture>& captures() const { return results; }
+
+private:
+  // A deque keeps each z where its stream is writing while new captures are added
+  deque<WitnessCapture> results;
+  unique_ptr<WitnessStream> stream;
+};
+
+#endif  // WITNESS_STREAM_H
@@ -14,6 +14,9 @@
 
 
 #include "lib/fidesinnova.h"
+#include "lib/nativeTracer.h"
+#include "lib/witnessStream.h"
+#include "lib/decodeTable.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -26,6 +29,8 @@ using ordered_json = nlohmann::ordered_json;
 #include <random>
 #include <chrono>
 #include <cstdlib>
+#include <future>
+#include <map>
 
 using namespace std;
 using namespace chrono;
@@ -33,6 +38,24 @@ using namespace chrono;
 vector<int64_t> z_array;
 int64_t input_value = 0;
 int64_t output_value = 0;
+// Witnesses of every captured execution when tracing with --regions/--captures
+WitnessBatch witnessBatch;
+
+// Function to get the label and file name suffix of a code block: none for the
+// first one (zkp_start, program_commitment.json), "_<region>" for the others
+std::string regionSuffix(size_t region) {
+  return region == 0 ? "" : "_" + to_string(region);
+}
+
+// Function to quote an argument for std::system, so paths with spaces or
+// shell characters reach the command as one word
+std::string shellQuote(const std::string& argument) {
+  std::string quoted = "'";
+  for (char c : argument) {
+    quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+  }
+  return quoted + "'";
+}
 
 // Function to clean up the GDB output file
 void cleanupTraceFile(const std::string& filename) {
@@ -95,13 +118,8 @@ void cleanupTraceFile(const std::string& filename) {
   outFile.close();
 }
 
-void run_the_user_program(int argc, char* argv[]) {
-  if (argc < 2) {
-      std::cerr << "Usage: " << argv[0] << " <program_to_execute>" << std::endl;
-  }
-
-  std::string program = argv[1];
-  std::string gdbCommand = "gdb --batch --command=gdb_commands.txt " + program + " > /dev/null 2>&1";
+void run_the_user_program_with_gdb(const std::string& program) {
+  std::string gdbCommand = "gdb --batch --command=gdb_commands.txt " + shellQuote(program) + " > /dev/null 2>&1";
   std::string outputFile = "execution_trace.txt";
 
   // Create a GDB command file
@@ -134,7 +152,9 @@ void run_the_user_program(int argc, char* argv[]) {
   gdbCommands.close();
 
   // Execute the GDB command and suppress terminal output
+  auto traceStart = steady_clock::now();
   int result = std::system(gdbCommand.c_str());
+  double traceSeconds = duration<double>(steady_clock::now() - traceStart).count();
   if (result != 0) {
       std::cerr << "GDB execution failed." << std::endl;
   }
@@ -142,14 +162,29 @@ void run_the_user_program(int argc, char* argv[]) {
   // Clean up the trace file
   cleanupTraceFile(outputFile);
 
+  std::ifstream traceFile(outputFile);
+  std::string traceLine;
+  uint64_t instructions = 0;
+  while (std::getline(traceFile, traceLine)) {
+    if (traceLine.find("=>") != std::string::npos) {
+      instructions++;
+    }
+  }
+  std::cout << "gdb traced " << instructions << " instructions in " << traceSeconds * 1000 << " ms ("
+            << (traceSeconds > 0 ? instructions / traceSeconds : 0) << " instructions/s)" << std::endl;
+
   std::cout << "Execution trace saved and cleaned in " << outputFile << std::endl;
 }
 
 
-void process_execution_trace_file() {
+// Function to build z_array from the gdb text trace. The destination register of
+// each step comes from the static decode table, so only the address after "=>"
+// and the one register line holding the result are parsed.
+bool process_execution_trace_file(DecodeTable& table) {
   ifstream file("execution_trace.txt");
   if (!file) {
       cerr << "Error opening file" << endl;
+      return false;
   }
 
   string line;
@@ -159,17 +194,13 @@ void process_execution_trace_file() {
   string hex_val;
   int64_t int_val;
 
-  stringstream ss(line);
-  string instruction;
-  string dest_reg;
-  string src_reg1;
-  string src_reg2;
-  string immediate;
+  const DecodedInstruction* decoded = nullptr;
+  bool rebased = false;
   bool first_instruction = true;
   while (getline(file, line)) {
     line_number++;
-    stringstream ss(line);
     if (line_number <= 31) {
+      stringstream ss(line);
       if(line_number == 1) {
         z_array.push_back(1);
       }
@@ -178,25 +209,33 @@ void process_execution_trace_file() {
       if(line_number == 31) {
         z_array.push_back(0);
       }
+      continue;
     }
-    if (line.find("=>") != string::npos) {
-      
+    if (line.compare(0, 2, "=>") == 0) {
+      uint64_t pc = strtoull(line.c_str() + 2, nullptr, 16);
+      if (!rebased) {
+        // The first traced instruction is the first one of the block
+        table.rebase(pc);
+        rebased = true;
+      }
+      decoded = table.find(pc);
+      if (!decoded) {
+        cerr << "Error: 0x" << hex << pc << dec << " is outside the decoded code block" << endl;
+        return false;
+      }
       line_number = 100;
-      ss.ignore(256, ':');
-      ss >> instruction >> dest_reg >> src_reg1;
-      dest_reg = Polynomial::trim(dest_reg);
-      dest_reg = Polynomial::removeCommas(dest_reg);
+      continue;
     }
-    if(line_number >= 101 && line_number <= 131) {
+    // The registers follow in the order x0..x30; only Rd's line matters
+    if (decoded && decoded->row != 0 && line_number == 101 + decoded->rd) {
+      stringstream ss(line);
       ss >> reg_name >> hex_val >> int_val;
-      if(dest_reg == reg_name) {
-        if(first_instruction) {
-          input_value = z_array[line_number-100];
-          first_instruction = false;
-        }
-        output_value = int_val;
-        z_array.push_back(int_val);
+      if(first_instruction) {
+        input_value = z_array[decoded->rd + 1];
+        first_instruction = false;
       }
+      output_value = int_val;
+      z_array.push_back(int_val);
     }
   }
 
@@ -206,14 +245,229 @@ void process_execution_trace_file() {
   for (const auto &val : z_array) {
       cout << val << endl;  // Output as decimal integers
   }
+  return true;
 }
 
 
-void proofGenerator() {
-  cout << "\n\n\n\n*** Start proof generation ***" << endl;
+// Function to build z_array from the binary trace written by the native tracer.
+// The file is memory-mapped and decoded one step at a time, so no text is parsed.
+bool process_execution_trace_binary(const std::string& traceFile, bool exportText) {
+  ExecutionTraceReader reader;
+  if (!reader.open(traceFile)) {
+    return false;
+  }
+  if (exportText && !reader.exportText("execution_trace.txt")) {
+    std::cerr << "Error: Unable to export execution_trace.txt" << std::endl;
+  }
+
+  const RegisterSnapshot& initial = reader.header().initial;
+  z_array.reserve(32 + reader.header().stepCount);
+  z_array.push_back(1);
+  for (int i = 0; i < 31; i++) {
+    z_array.push_back(int64_t(initial.x[i]));
+  }
+  z_array.push_back(0);
+
+  bool first_instruction = true;
+  uint64_t decoded = 0;
+  TraceStep step;
+  while (reader.next(step)) {
+    decoded++;
+    uint32_t rd = destinationRegister(step.instruction);
+    if (rd == 31) {
+      continue;  // no register written, or xzr/sp: not part of the witness
+    }
+    if (first_instruction) {
+      input_value = z_array[rd + 1];
+      first_instruction = false;
+    }
+    output_value = int64_t(step.registers.x[rd]);
+    z_array.push_back(output_value);
+  }
+  if (decoded != reader.header().stepCount) {
+    std::cerr << "Error: " << traceFile << " ended after " << decoded << " of "
+              << reader.header().stepCount << " steps" << std::endl;
+    return false;
+  }
+
+  // Output results as integers
+  for (const auto &val : z_array) {
+      cout << val << endl;  // Output as decimal integers
+  }
+  return true;
+}
+
+// Function to trace an aarch64 program under qemu-aarch64 with the Fides TCG
+// plugin (libfidesTrace.so); lets x86 hosts produce execution_trace.bin
+bool run_the_user_program_with_qemu(const std::string& program, const std::string& traceFile, TraceMode mode) {
+  uint64_t start, end, code;
+  if (!NativeTracer::findSymbol(program, "zkp_start", start) || !NativeTracer::findSymbol(program, "zkp_end", end) ||
+      !NativeTracer::findCodeStart(program, code)) {
+    return false;
+  }
+  if (traceFile.find(',') != std::string::npos) {
+    std::cerr << "Error: the qemu plugin options cannot hold a trace file name with a comma" << std::endl;
+    return false;
+  }
+  const char* modeName = mode == TraceMode::Destination ? "destination" : (mode == TraceMode::Delta ? "delta" : "snapshot");
+  std::stringstream plugin;
+  plugin << "./libfidesTrace.so,trace=" << traceFile << std::hex << std::showbase
+         << ",start=" << start << ",end=" << end << ",code=" << code << ",mode=" << modeName;
+  std::string command = "qemu-aarch64 -plugin " + shellQuote(plugin.str()) + " " + shellQuote(program) + " > /dev/null";
+
+  auto traceStart = high_resolution_clock::now();
+  int result = std::system(command.c_str());
+  double traceSeconds = duration<double>(high_resolution_clock::now() - traceStart).count();
+  if (result != 0) {
+    std::cerr << "qemu-aarch64 failed with code " << result << std::endl;
+    return false;
+  }
+  std::cout << "qemu traced " << program << " in " << traceSeconds * 1000 << " ms" << std::endl;
+  return true;
+}
+
+// Function to trace the code block of the user program and fill z_array.
+// The native ptrace tracer is used unless --gdb or --qemu is given. By default
+// its steps are streamed into z_array; --trace-file keeps execution_trace.bin
+// and builds z_array from it, and --text-trace also writes it out as
+// execution_trace.txt. --qemu always goes through execution_trace.bin.
+// --regions N traces the N code blocks the commitmentGenerator labelled and
+// --captures N keeps tracing until N executions were captured (or the program
+// exits); each execution then gets its own witness in witnessBatch.
+bool run_the_user_program(int argc, char* argv[]) {
+  bool useGdb = false;
+  bool useQemu = false;
+  bool traceFile = false;
+  bool textTrace = false;
+  uint64_t regionCount = 1;
+  uint64_t maxCaptures = 1;
+  std::string program;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if ((arg == "--regions" || arg == "--captures") && i + 1 < argc) {
+      uint64_t value = std::strtoull(argv[++i], nullptr, 10);
+      (arg == "--regions" ? regionCount : maxCaptures) = value;
+    } else if (arg == "--gdb") {
+      useGdb = true;
+    } else if (arg == "--qemu") {
+      useQemu = true;
+    } else if (arg == "--trace-file") {
+      traceFile = true;
+    } else if (arg == "--text-trace") {
+      traceFile = true;
+      textTrace = true;
+    } else {
+      program = arg;
+    }
+  }
+  if (program.empty()) {
+      std::cerr << "Usage: " << argv[0] << " [--gdb | --qemu] [--trace-file] [--text-trace] "
+                << "[--regions N] [--captures N] <program_to_execute>" << std::endl;
+      return false;
+  }
+
+  if (regionCount > 1 || maxCaptures > 1) {
+    if (regionCount == 0 || maxCaptures == 0 || useGdb || useQemu || traceFile) {
+      std::cerr << "--regions and --captures need positive counts and the native tracer" << std::endl;
+      return false;
+    }
+    vector<TraceRegion> regions;
+    for (uint64_t r = 0; r < regionCount; r++) {
+      regions.push_back({ "zkp_start" + regionSuffix(r), "zkp_end" + regionSuffix(r) });
+    }
+    NativeTracer tracer;
+    if (!tracer.traceRegions(program, regions, witnessBatch, maxCaptures) || tracer.captureCount() == 0) {
+      std::cerr << "Tracing " << program << " failed." << std::endl;
+      return false;
+    }
+    std::cout << "Captured " << tracer.captureCount() << " executions of " << regionCount << " region(s), "
+              << tracer.stepCount() << " instructions (" << tracer.instructionsPerSecond() << " instructions/s)"
+              << std::endl;
+    return true;
+  }
+
+  if (useGdb) {
+    DecodeTable table;
+    if (!table.build(program)) {
+      return false;
+    }
+    run_the_user_program_with_gdb(program);
+    return process_execution_trace_file(table);
+  }
+
+  const std::string traceFilePath = "execution_trace.bin";
+  // The witness only needs each destination register; keep every changed
+  // register when a readable dump was asked for
+  TraceMode traceMode = textTrace ? TraceMode::Delta : TraceMode::Destination;
+
+  if (useQemu) {
+    return run_the_user_program_with_qemu(program, traceFilePath, traceMode) &&
+           process_execution_trace_binary(traceFilePath, textTrace);
+  }
+
+  NativeTracer tracer;
+  if (!traceFile) {
+    // Build z_array while the program is still being single-stepped
+    WitnessStream stream(z_array);
+    bool traced = tracer.trace(program, &stream);
+    stream.finish();
+    if (!traced) {
+      std::cerr << "Tracing " << program << " failed." << std::endl;
+      return false;
+    }
+    input_value = stream.inputValue();
+    output_value = stream.outputValue();
+    std::cout << "Traced " << tracer.stepCount() << " instructions (" << tracer.instructionsPerSecond()
+              << " instructions/s) straight into z_array (" << stream.producerStalls() << " queue stalls)" << std::endl;
+
+    // Output results as integers
+    for (const auto &val : z_array) {
+        cout << val << endl;  // Output as decimal integers
+    }
+    return true;
+  }
+
+  ExecutionTraceWriter writer;
+  if (!writer.open(traceFilePath, traceMode)) {
+    return false;
+  }
+  bool traced = tracer.trace(program, &writer);
+  if (!writer.close() || !traced) {
+    std::cerr << "Tracing " << program << " failed." << std::endl;
+    return false;
+  }
+  std::cout << "Traced " << tracer.stepCount() << " instructions (" << tracer.instructionsPerSecond()
+            << " instructions/s) into " << traceFilePath << " (" << writer.bytesWritten() << " bytes)" << std::endl;
+  return process_execution_trace_binary(traceFilePath, textTrace);
+}
+
+
+// Everything the prover needs that does not depend on the witness: the
+// commitment, the R1CS parameters, the class, the setup keys and the H and K
+// domains. It is loaded while the user program is being traced.
+struct ProverSetup {
+  uint64_t Class;
+  std::string commitmentID;
+  vector<uint64_t> rowA_x, colA_x, valA_x, rowB_x, colB_x, valB_x, rowC_x, colC_x, valC_x;
+  vector<uint64_t> nonZeroA;
+  vector<vector<uint64_t>> nonZeroB;
+  vector<uint64_t> rowA, colA, valA, rowB, colB, valB, rowC, colC, valC;
+  uint64_t n_i, n_g, m, n, p, g;
+  vector<uint64_t> ck;
+  uint64_t vk;
+  vector<vector<uint64_t>> A, B, C;
+  vector<uint64_t> H, K;
+  vector<uint64_t> vH_x, vK_x;
+  double seconds = 0;
+};
+
+// Function to load the commitment, parameters, class and setup of one code block
+// (see regionSuffix) and build the domains
+ProverSetup loadProverSetup(const std::string& suffix) {
+  auto setup_start = high_resolution_clock::now();
 
   // Hardcoded file path
-  const char* commitmentJsonFilePath = "data/program_commitment.json";
+  std::string commitmentJsonFilePath = "data/program_commitment" + suffix + ".json";
 
   // Parse the JSON file
   nlohmann::json commitmentJsonData;
@@ -222,7 +476,7 @@ void proofGenerator() {
     commitmentJsonFile >> commitmentJsonData;
     commitmentJsonFile.close();
   } catch (nlohmann::json::parse_error& e) {
-    cout << "Enter the content of program_commitment.json file! (end with a blank line):" << endl;
+    cout << "Enter the content of " << commitmentJsonFilePath << " file! (end with a blank line):" << endl;
     string commitmentJsonInput;
     string commitmentJsonLines;
     while (getline(cin, commitmentJsonLines)) {
@@ -248,7 +502,7 @@ void proofGenerator() {
 
 
   // Hardcoded file path
-  const char* paramJsonFilePath = "data/program_param.json";
+  std::string paramJsonFilePath = "data/program_param" + suffix + ".json";
 
   // Parse the JSON file
   nlohmann::json paramJsonData;
@@ -257,7 +511,7 @@ void proofGenerator() {
     paramJsonFile >> paramJsonData;
     paramJsonFile.close();
   } catch (nlohmann::json::parse_error& e) {
-    cout << "Enter the content of program_param.json file! (end with a blank line):" << endl;
+    cout << "Enter the content of " << paramJsonFilePath << " file! (end with a blank line):" << endl;
     string paramJsonInput;
     string paramJsonLines;
     while (getline(cin, paramJsonLines)) {
@@ -309,13 +563,6 @@ void proofGenerator() {
   p   = classJsonData[class_value]["p"].get<uint64_t>();
   g   = classJsonData[class_value]["g"].get<uint64_t>();
 
-  uint64_t upper_limit = (n_g < 10) ? n_g - 1 : 9;
-  // Set up random number generation
-  std::random_device rd;  // Seed
-  std::mt19937_64 gen(rd()); // Random number engine
-  std::uniform_int_distribution<uint64_t> dis(0, upper_limit);
-  int64_t b = dis(gen);
-
   // Hardcoded file path
   std::string setupJsonFilePath = "data/setup" + class_value + ".json";
   const char* setupJsonFilePathCStr = setupJsonFilePath.c_str();
@@ -340,28 +587,6 @@ void proofGenerator() {
   vector<uint64_t> ck = setupJsonData["ck"].get<vector<uint64_t>>();
   uint64_t vk = setupJsonData["vk"].get<uint64_t>();
 
-
-  // Measure the start time
-  auto start_time = high_resolution_clock::now();
-  vector<uint64_t> z;
-  for(uint64_t i = 0; i < (1 + n_i + n_g); i++) {
-    cout << "z_array" << "[" << i << "] = " << z_array[i] % p << endl;
-    int64_t bufferZ = z_array[i] % p;
-    if (bufferZ < 0) {
-      bufferZ += p;
-    }
-    z.push_back(bufferZ);
-  }
-
-  cout << "\n\n" << endl;
-  cout << "z" << "[";
-  for(uint64_t i = 0; i < (1 + n_i + n_g); i++) {
-    cout << z[i] << ", ";
-  }
-  cout << "]" << endl;
-
-  uint64_t t = n_i + 1;
-
   cout << "Initialize matrices A, B, C" << endl;
   // Initialize matrices A, B, C
   vector<vector<uint64_t>> A(n, vector<uint64_t>(n, 0ll));
@@ -432,6 +657,126 @@ void proofGenerator() {
   }
   cout << endl;
 
+  vector<uint64_t> vH_x(n + 1, 0);
+  vH_x[0] = p - 1;
+  vH_x[n] = 1;
+  Polynomial::printPolynomial(vH_x, "vH(x)");
+
+
+  vector<uint64_t> vK_x = Polynomial::createLinearPolynomial(K[0]);
+  // Multiply (x - K) for all other K
+  for (size_t i = 1; i < K.size(); i++) {
+    vector<uint64_t> nextPoly = Polynomial::createLinearPolynomial(K[i]);
+    vK_x = Polynomial::multiplyPolynomials(vK_x, nextPoly, p);
+  }
+  Polynomial::printPolynomial(vK_x, "vK(x)");
+
+  ProverSetup setup;
+  setup.Class = std::move(Class);
+  setup.commitmentID = std::move(commitmentID);
+  setup.rowA_x = std::move(rowA_x);
+  setup.colA_x = std::move(colA_x);
+  setup.valA_x = std::move(valA_x);
+  setup.rowB_x = std::move(rowB_x);
+  setup.colB_x = std::move(colB_x);
+  setup.valB_x = std::move(valB_x);
+  setup.rowC_x = std::move(rowC_x);
+  setup.colC_x = std::move(colC_x);
+  setup.valC_x = std::move(valC_x);
+  setup.nonZeroA = std::move(nonZeroA);
+  setup.nonZeroB = std::move(nonZeroB);
+  setup.rowA = std::move(rowA);
+  setup.colA = std::move(colA);
+  setup.valA = std::move(valA);
+  setup.rowB = std::move(rowB);
+  setup.colB = std::move(colB);
+  setup.valB = std::move(valB);
+  setup.rowC = std::move(rowC);
+  setup.colC = std::move(colC);
+  setup.valC = std::move(valC);
+  setup.ck = std::move(ck);
+  setup.A = std::move(A);
+  setup.B = std::move(B);
+  setup.C = std::move(C);
+  setup.H = std::move(H);
+  setup.K = std::move(K);
+  setup.vH_x = std::move(vH_x);
+  setup.vK_x = std::move(vK_x);
+  setup.n_i = n_i;
+  setup.n_g = n_g;
+  setup.m = m;
+  setup.n = n;
+  setup.p = p;
+  setup.g = g;
+  setup.vk = vk;
+  setup.seconds = duration<double>(high_resolution_clock::now() - setup_start).count();
+  return setup;
+}
+
+void proofGenerator(const ProverSetup& setup, const std::string& proofPath) {
+  cout << "\n\n\n\n*** Start proof generation ***" << endl;
+
+  const uint64_t Class = setup.Class;
+  const std::string& commitmentID = setup.commitmentID;
+  const vector<uint64_t>& rowA_x = setup.rowA_x;
+  const vector<uint64_t>& colA_x = setup.colA_x;
+  const vector<uint64_t>& valA_x = setup.valA_x;
+  const vector<uint64_t>& rowB_x = setup.rowB_x;
+  const vector<uint64_t>& colB_x = setup.colB_x;
+  const vector<uint64_t>& valB_x = setup.valB_x;
+  const vector<uint64_t>& rowC_x = setup.rowC_x;
+  const vector<uint64_t>& colC_x = setup.colC_x;
+  const vector<uint64_t>& valC_x = setup.valC_x;
+  const vector<uint64_t>& nonZeroA = setup.nonZeroA;
+  const vector<uint64_t>& rowA = setup.rowA;
+  const vector<uint64_t>& colA = setup.colA;
+  const vector<uint64_t>& valA = setup.valA;
+  const vector<uint64_t>& rowB = setup.rowB;
+  const vector<uint64_t>& colB = setup.colB;
+  const vector<uint64_t>& valB = setup.valB;
+  const vector<uint64_t>& rowC = setup.rowC;
+  const vector<uint64_t>& colC = setup.colC;
+  const vector<uint64_t>& valC = setup.valC;
+  const vector<uint64_t>& ck = setup.ck;
+  const vector<uint64_t>& H = setup.H;
+  const vector<uint64_t>& K = setup.K;
+  const vector<uint64_t>& vH_x = setup.vH_x;
+  const vector<uint64_t>& vK_x = setup.vK_x;
+  const vector<vector<uint64_t>>& nonZeroB = setup.nonZeroB;
+  const vector<vector<uint64_t>>& A = setup.A;
+  const vector<vector<uint64_t>>& B = setup.B;
+  const vector<vector<uint64_t>>& C = setup.C;
+  const uint64_t n_i = setup.n_i, n_g = setup.n_g, n = setup.n, p = setup.p;
+
+  uint64_t upper_limit = (n_g < 10) ? n_g - 1 : 9;
+  // Set up random number generation
+  std::random_device rd;  // Seed
+  std::mt19937_64 gen(rd()); // Random number engine
+  std::uniform_int_distribution<uint64_t> dis(0, upper_limit);
+  int64_t b = dis(gen);
+
+
+
+  // Measure the start time
+  auto start_time = high_resolution_clock::now();
+  vector<uint64_t> z;
+  for(uint64_t i = 0; i < (1 + n_i + n_g); i++) {
+    cout << "z_array" << "[" << i << "] = " << z_array[i] % p << endl;
+    int64_t bufferZ = z_array[i] % p;
+    if (bufferZ < 0) {
+      bufferZ += p;
+    }
+    z.push_back(bufferZ);
+  }
+
+  cout << "\n\n" << endl;
+  cout << "z" << "[";
+  for(uint64_t i = 0; i < (1 + n_i + n_g); i++) {
+    cout << z[i] << ", ";
+  }
+  cout << "]" << endl;
+
+  uint64_t t = n_i + 1;
 
   vector<vector<uint64_t>> Az(n, vector<uint64_t>(1, 0));
   vector<vector<uint64_t>> Bz(n, vector<uint64_t>(1, 0));
@@ -575,19 +920,6 @@ void proofGenerator() {
   Polynomial::printPolynomial(zAzB_zC, "zA(x)zB(x)-zC(x)");
 
 
-  vector<uint64_t> vH_x(n + 1, 0);
-  vH_x[0] = p - 1;
-  vH_x[n] = 1;
-  Polynomial::printPolynomial(vH_x, "vH(x)");
-
-
-  vector<uint64_t> vK_x = Polynomial::createLinearPolynomial(K[0]);
-  // Multiply (x - K) for all other K
-  for (size_t i = 1; i < K.size(); i++) {
-    vector<uint64_t> nextPoly = Polynomial::createLinearPolynomial(K[i]);
-    vK_x = Polynomial::multiplyPolynomials(vK_x, nextPoly, p);
-  }
-  Polynomial::printPolynomial(vK_x, "vK(x)");
 
   // Dividing the product of zAzB_zC by vH_x
   vector<uint64_t> h_0_x = Polynomial::dividePolynomials(zAzB_zC, vH_x, p)[0];
@@ -1043,20 +1375,57 @@ void proofGenerator() {
   cout << "Time taken: " << duration.count() << " milliseconds" << endl;
 
   std::string proofString = proof.dump(4);
-  std::ofstream proofFile("data/proof.json");
+  std::ofstream proofFile(proofPath);
   if (proofFile.is_open()) {
       proofFile << proofString;
       proofFile.close();
-      std::cout << "JSON data has been written to proof.json\n";
+      std::cout << "JSON data has been written to " << proofPath << "\n";
   } else {
       // std::cerr << "Error opening file for writing proof.json\n";
   }
 }
 
 
+// Function to prove every captured execution; each region's setup is loaded once
+// and shared by all of its executions
+void proveBatch(ProverSetup firstSetup) {
+  map<size_t, ProverSetup> setups;
+  setups.emplace(0, std::move(firstSetup));
+  auto batch_start = high_resolution_clock::now();
+  for (const WitnessCapture& capture : witnessBatch.captures()) {
+    auto setup = setups.find(capture.region);
+    if (setup == setups.end()) {
+      setup = setups.emplace(capture.region, loadProverSetup(regionSuffix(capture.region))).first;
+    }
+    z_array = capture.z;
+    input_value = capture.input;
+    output_value = capture.output;
+    proofGenerator(setup->second, "data/proof_" + to_string(capture.region) + "_" + to_string(capture.execution) + ".json");
+  }
+  double batchSeconds = duration<double>(high_resolution_clock::now() - batch_start).count();
+  size_t count = witnessBatch.captures().size();
+  cout << "Proved " << count << " executions in " << batchSeconds * 1000 << " ms ("
+       << batchSeconds * 1000 / count << " ms per proof)" << endl;
+}
+
+
 int main(int argc, char* argv[]) {
-  run_the_user_program(argc, argv);
-  process_execution_trace_file();
-  proofGenerator();
+  // Loading the commitment and setup and building the domains does not need
+  // the witness, so it runs while the program is traced
+  auto total_start = high_resolution_clock::now();
+  future<ProverSetup> pendingSetup = async(launch::async, loadProverSetup, std::string());
+  if (!run_the_user_program(argc, argv)) {
+    return 1;
+  }
+  double traceSeconds = duration<double>(high_resolution_clock::now() - total_start).count();
+  ProverSetup setup = pendingSetup.get();
+  cout << "Tracing took " << traceSeconds * 1000 << " ms, setup took " << setup.seconds * 1000
+       << " ms, both done after " << duration<double>(high_resolution_clock::now() - total_start).count() * 1000
+       << " ms" << endl;
+  if (!witnessBatch.captures().empty()) {
+    proveBatch(std::move(setup));
+    return 0;
+  }
+  proofGenerator(setup, "data/proof.json");
   return 0;
 }
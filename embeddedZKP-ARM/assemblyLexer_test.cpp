@@ -0,0 +1,113 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the assembly lexer the commitmentGenerator front end is built on.
+// `g++ -std=c++17 assemblyLexer_test.cpp lib/assemblyLexer.cpp -o assemblyLexer_test`
+
+#include "lib/assemblyLexer.h"
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdio>
+
+void test_register_names() {
+    assert(registerIndex("x0") == 0);
+    assert(registerIndex("x30") == 30);
+    assert(registerIndex("w17") == 17);
+    assert(registerIndex("r15") == 15);
+    assert(registerIndex("sp") == 31);
+    assert(registerIndex("xzr") == 31);
+    assert(registerIndex("lr") == 14);
+    assert(registerIndex("x31") == -1);
+    assert(registerIndex("r16") == -1);
+    assert(registerIndex("x01") == -1);
+    assert(registerIndex("#1") == -1);
+    assert(registerIndex("x") == -1);
+    std::cout << "register names: ok\n";
+}
+
+void test_immediates() {
+    int64_t value;
+    assert(parseImmediate("#28", value) && value == 28);
+    assert(parseImmediate("7", value) && value == 7);
+    assert(parseImmediate("#0x1c", value) && value == 28);
+    assert(parseImmediate("#-3", value) && value == -3);
+    assert(!parseImmediate("x3", value));
+    assert(!parseImmediate("#", value));
+    assert(!parseImmediate("#12abc", value));
+    std::cout << "immediates: ok\n";
+}
+
+void test_instructions() {
+    AssemblyInstruction add = lexInstruction("\tadd\tx3, x1, #28", 7);
+    assert(add.line == 7 && add.opcode == Opcode::Add && add.rd == 3);
+    assert(add.left.kind == Operand::Kind::Register && add.left.reg == 1);
+    assert(add.right.kind == Operand::Kind::Immediate && add.right.immediate == 28);
+    assert(add.registersUsed == ((1u << 3) | (1u << 1)));
+
+    AssemblyInstruction mul = lexInstruction("mul x5,x4,x2 // comment x9", 1);
+    assert(mul.opcode == Opcode::Mul && mul.rd == 5 && mul.left.reg == 4 && mul.right.reg == 2);
+    assert(mul.right.text == "x2");
+    assert(!(mul.registersUsed & (1u << 9)));
+
+    AssemblyInstruction store = lexInstruction("\tstp\tx29, x30, [sp, -16]!", 1);
+    assert(store.opcode == Opcode::Other && store.rd == 29);
+    assert(store.registersUsed == ((1u << 29) | (1u << 30)));
+
+    AssemblyInstruction label = lexInstruction("main:", 1);
+    assert(label.opcode == Opcode::Other && label.rd == noRegister);
+    std::cout << "instructions: ok\n";
+}
+
+void test_source_lines() {
+    const char* path = "assemblyLexer_test.s";
+    {
+        std::ofstream file(path);
+        file << "main:\n\tmul\tx1, x1, x2\n\n\tadd\tx1, x1, #3\r\n\tret";
+    }
+    AssemblySource source;
+    bool opened = source.open(path);
+    assert(opened);
+    assert(source.lineCount() == 5);
+    assert(source.line(1) == "main:");
+    assert(source.line(3).empty());
+    assert(source.line(5) == "\tret");
+    assert(source.line(6).empty());
+
+    vector<AssemblyInstruction> block = source.lex(2, 4);
+    assert(block.size() == 3);
+    assert(block[0].opcode == Opcode::Mul && block[0].line == 2);
+    assert(block[2].opcode == Opcode::Add && block[2].right.immediate == 3);
+    assert(source.lex(6, 9).empty());
+
+    // Reopening releases the previous mapping and its lines
+    {
+        std::ofstream file(path);
+        file << "\tmul\tx1, x1, x2\n";
+    }
+    opened = source.open(path);
+    assert(opened && source.lineCount() == 1 && source.line(2).empty());
+    opened = source.open("missing_assemblyLexer_test.s");
+    assert(!opened && source.lineCount() == 0 && source.line(1).empty());
+    std::remove(path);
+    std::cout << "source lines: ok\n";
+}
+
+int main() {
+    test_register_names();
+    test_immediates();
+    test_instructions();
+    test_source_lines();
+    return 0;
+}
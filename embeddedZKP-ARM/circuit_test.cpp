@@ -0,0 +1,153 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs small code blocks, builds z from the recorded instructions the way the
+// instrumentation does, and checks every row of the optimized circuit.
+// `g++ -std=c++17 circuit_test.cpp lib/assemblyLexer.cpp lib/circuit.cpp -o circuit_test`
+
+#include "lib/circuit.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+const uint64_t n_i = 32;
+const uint64_t p = 5087281;
+
+vector<AssemblyInstruction> lexBlock(const vector<string_view>& lines) {
+    vector<AssemblyInstruction> block;
+    for (size_t i = 0; i < lines.size(); i++) {
+        block.push_back(lexInstruction(lines[i], i + 1));
+    }
+    return block;
+}
+
+// Function to execute the block and check (A z) * (B z) = z[row] for every gate
+bool satisfied(const vector<AssemblyInstruction>& block, const Circuit& circuit, uint64_t seed) {
+    mt19937_64 random(seed);
+    vector<uint64_t> x(32, 0);
+    vector<uint64_t> z(1, 1);
+    for (int i = 0; i < 31; i++) {
+        x[i] = random() % 100;
+        z.push_back(x[i]);
+    }
+    z.push_back(1);
+
+    auto value = [&](const Operand& operand) {
+        return operand.kind == Operand::Kind::Immediate ? uint64_t(operand.immediate) : x[operand.reg];
+    };
+    for (size_t i = 0; i < block.size(); i++) {
+        const AssemblyInstruction& instruction = block[i];
+        // Long mul chains would wrap at 2^64, which the field does not model
+        uint64_t result = instruction.opcode == Opcode::Add
+            ? (value(instruction.left) + value(instruction.right)) % p
+            : value(instruction.left) * value(instruction.right) % p;
+        x[instruction.rd] = result;
+        if (circuit.recorded[i]) {
+            z.push_back(result);
+        }
+    }
+    assert(z.size() == 1 + n_i + circuit.gates.size());
+
+    auto evaluate = [&](const vector<CircuitTerm>& row) {
+        uint64_t sum = 0;
+        for (const auto& term : row) {
+            sum = (sum + term.coefficient * (z[circuit.column(term)] % p)) % p;
+        }
+        return sum;
+    };
+    for (size_t g = 0; g < circuit.gates.size(); g++) {
+        // The prover rebuilds A as a single column with value 1
+        assert(circuit.gates[g].a.size() == 1 && circuit.gates[g].a[0].coefficient == 1);
+        if (evaluate(circuit.gates[g].a) * evaluate(circuit.gates[g].b) % p != z[1 + n_i + g] % p) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_unoptimized_is_one_to_one() {
+    vector<AssemblyInstruction> block = lexBlock({"mul x1, x1, x2", "add x3, x1, #28"});
+    Circuit circuit = buildCircuit(block, n_i, p);
+    assert(circuit.gates.size() == 2);
+    assert(circuit.column(circuit.gates[0].a[0]) == 2);
+    assert(circuit.column(circuit.gates[1].b[0]) == 33);  // reads the first gate
+    assert(satisfied(block, circuit, 1));
+    std::cout << "unoptimized: ok\n";
+}
+
+void test_duplicated_operand() {
+    // Without the optimizer the terms stay as the instruction wrote them
+    vector<AssemblyInstruction> block = lexBlock({"add x3, x1, x1", "mul x4, x3, #0"});
+    Circuit circuit = buildCircuit(block, n_i, p);
+    assert(circuit.gates[0].b.size() == 2);
+    assert(circuit.column(circuit.gates[0].b[0]) == 2 && circuit.column(circuit.gates[0].b[1]) == 2);
+    assert(circuit.gates[1].b.empty());
+
+    // The optimizer adds them up into one term with coefficient 2
+    optimizeCircuit(circuit);
+    assert(circuit.gates[0].b.size() == 1 && circuit.gates[0].b[0].coefficient == 2);
+    assert(satisfied(block, circuit, 3));
+    std::cout << "duplicated operand: ok\n";
+}
+
+void test_fold_merge_dead() {
+    vector<AssemblyInstruction> block = lexBlock({
+        "mul x1, x1, #3",
+        "add x1, x1, #28",   // merged with the mul
+        "add x1, x1, x2",    // merged
+        "add x5, x2, x2",    // dead: x5 is overwritten unread
+        "add x5, #2, #3",    // constant
+        "mul x1, x1, x5",    // 5 * (...) merged into the product
+        "mul x1, x1, x2",
+        "add x1, x1, x1"
+    });
+    Circuit circuit = buildCircuit(block, n_i, p);
+    vector<AssemblyInstruction> copy = block;
+    OptimizerReport report = optimizeCircuit(circuit);
+    assert(report.gatesBefore == 8);
+    assert(report.dead == 1);
+    assert(report.gatesAfter == 8 - report.folded - report.merged - report.dead);
+    assert(report.merged == 4);
+    assert(report.gatesAfter == 3);  // x5 = 5 leaves the block, so it stays as a constant row
+    assert(!circuit.recorded[0] && !circuit.recorded[3] && circuit.recorded[7]);
+    assert(satisfied(copy, circuit, 2));
+    std::cout << "fold, merge, dead: ok\n";
+}
+
+void test_random_blocks() {
+    mt19937_64 random(7);
+    for (int round = 0; round < 500; round++) {
+        vector<std::string> text;
+        for (int i = 0; i < 12; i++) {
+            auto operand = [&]() {
+                return random() % 3 == 0 ? "#" + to_string(random() % 10) : "x" + to_string(1 + random() % 5);
+            };
+            text.push_back(std::string(random() % 2 ? "add" : "mul") + " x" + to_string(1 + random() % 5) + ", " + operand() + ", " + operand());
+        }
+        vector<string_view> lines(text.begin(), text.end());
+        vector<AssemblyInstruction> block = lexBlock(lines);
+        Circuit circuit = buildCircuit(block, n_i, p);
+        optimizeCircuit(circuit);
+        assert(satisfied(block, circuit, round));
+    }
+    std::cout << "random blocks: ok\n";
+}
+
+int main() {
+    test_unoptimized_is_one_to_one();
+    test_duplicated_operand();
+    test_fold_merge_dead();
+    test_random_blocks();
+    return 0;
+}
@@ -14,6 +14,9 @@
 
 
 #include "lib/polynomial.h"
+#include "lib/assemblyLexer.h"
+#include "lib/circuit.h"
+#include "lib/srs.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -25,34 +28,23 @@ using ordered_json = nlohmann::ordered_json;
 #include <unordered_map>
 #include <chrono>
 #include <iomanip>
+#include <filesystem>
 
 using namespace std;
 
-// Map of ARM 32-bit registers
-std::unordered_map<std::string, int> registerMap = {
-  {"r0", 0},   {"r1", 1},   {"r2", 2},   {"r3", 3},
-  {"r4", 4},   {"r5", 5},   {"r6", 6},   {"r7", 7},
-  {"r8", 8},   {"r9", 9},   {"r10", 10}, {"r11", 11},
-  {"r12", 12}, {"r13", 13}, {"r14", 14}, {"r15", 15},
-  {"sp", 31},  // Stack Pointer (alias for r13)
-  {"lr", 14},  // Link Register (alias for r14)
-  {"pc", 15},  // Program Counter (alias for r15)
-  {"x0", 0},   {"x1", 1},   {"x2", 2},   {"x3", 3},
-  {"x4", 4},   {"x5", 5},   {"x6", 6},   {"x7", 7},
-  {"x8", 8},   {"x9", 9},   {"x10", 10}, {"x11", 11},
-  {"x12", 12}, {"x13", 13}, {"x14", 14}, {"x15", 15},
-  {"x16", 16},   {"x17", 17},   {"x18", 18},   {"x19", 19},
-  {"x20", 20},   {"x21", 21},   {"x22", 22},   {"x23", 23},
-  {"x24", 24},   {"x25", 25},   {"x26", 26},   {"x27", 27},
-  {"x28", 28},   {"x29", 29},   {"x30", 30}
-};
-
 uint64_t n_i, n_g, m, n, p, g;
 
-std::string configFilePath = "device_config.json", setupFilePath, assemblyFilePath = "program.s", newAssemblyFile = "program_new.s", commitmentFileName, paramFileName;
-
-std::vector<std::string> instructions;
-uint64_t Class;
+std::string configFilePath = "device_config.json", assemblyFilePath = "program.s", newAssemblyFile = "program_new.s", commitmentFileName, paramFileName;
+
+AssemblySource assemblySource;
+vector<AssemblyInstruction> instructions;
+Circuit circuit;
+bool optimizeGates = false;
+bool useCache = true;
+const std::string cacheDirectory = "data/cache";
+uint64_t Class = 0;
+nlohmann::json classJsonData;
+string instrumentationMode = "arrays";
 string commitmentID;
 string deviceType;
 string deviceIdType;
@@ -60,6 +52,38 @@ string deviceModel;
 string manufacturer;
 string softwareVersion;
 
+// Function to load the parameters of a class from class.json
+void selectClass(uint64_t selected) {
+  string class_value = to_string(selected); // Convert integer to string class
+  if (!classJsonData.contains(class_value)) {
+    throw std::runtime_error("Error: Fides commitmentGenerator cannot find class " + class_value + " in class.json.\n");
+  }
+  Class = selected;
+  n_g = classJsonData[class_value]["n_g"].get<uint64_t>();
+  n_i = classJsonData[class_value]["n_i"].get<uint64_t>();
+  n   = classJsonData[class_value]["n"].get<uint64_t>();
+  m   = classJsonData[class_value]["m"].get<uint64_t>();
+  p   = classJsonData[class_value]["p"].get<uint64_t>();
+  g   = classJsonData[class_value]["g"].get<uint64_t>();
+}
+
+// Function to find the class with the fewest gates that still holds the given number
+uint64_t smallestClass(uint64_t gates) {
+  uint64_t best = 0, bestGates = 0;
+  for (auto it = classJsonData.begin(); it != classJsonData.end(); ++it) {
+    uint64_t classGates = it.value()["n_g"].get<uint64_t>();
+    uint64_t classNumber = std::stoull(it.key());
+    if (classGates >= gates && (best == 0 || classGates < bestGates || (classGates == bestGates && classNumber < best))) {
+      best = classNumber;
+      bestGates = classGates;
+    }
+  }
+  if (best == 0) {
+    throw std::runtime_error("Error: The code_block has " + to_string(gates) + " gates, more than any class in class.json supports.\n");
+  }
+  return best;
+}
+
 // Function to read JSON config file and parse lines to read from assembly file
 std::pair<uint64_t, uint64_t> parseDeviceConfig(const std::string &configFile, nlohmann::json &config) {
   std::ifstream configFileStream(configFile, std::ifstream::binary);
@@ -74,204 +98,155 @@ std::pair<uint64_t, uint64_t> parseDeviceConfig(const std::string &configFile, n
 
   uint64_t startLine = config["code_block"][0].get<uint64_t>();
   uint64_t endLine = config["code_block"][1].get<uint64_t>();
-  Class = config["class"].get<uint64_t>();
+  // Without a class the smallest one that fits the code block is picked later
+  if (config.contains("class")) {
+    Class = config["class"].get<uint64_t>();
+  }
   deviceType = config["deviceType"].get<string>();
   deviceIdType = config["deviceIdType"].get<string>();
   deviceModel = config["deviceModel"].get<string>();
   manufacturer = config["manufacturer"].get<string>();
   softwareVersion = config["softwareVersion"].get<string>();
+  // "arrays" keeps one array per register plus a copy loop into z_array;
+  // "direct" writes every value straight into its z_array slot
+  if (config.contains("instrumentation")) {
+    instrumentationMode = config["instrumentation"].get<string>();
+    if (instrumentationMode != "arrays" && instrumentationMode != "direct") {
+      throw std::runtime_error("Error: Fides commitmentGenerator does not support the instrumentation '" + instrumentationMode + "'. Use 'arrays' or 'direct'.\n");
+    }
+  }
+  if (config.contains("optimize")) {
+    optimizeGates = config["optimize"].get<bool>();
+  }
+  if (config.contains("cache")) {
+    useCache = config["cache"].get<bool>();
+  }
 
   
   std::ifstream classFileStream("class.json");
   if (!classFileStream.is_open()) {
     throw std::runtime_error("Error: Fides commitmentGenerator cannot open class.json for reading proposes.\n");
   }
-  nlohmann::json classJsonData;
   classFileStream >> classJsonData;
   classFileStream.close();
-  string class_value = to_string(Class); // Convert integer to string class
-  n_g = classJsonData[class_value]["n_g"].get<uint64_t>();
-  n_i = classJsonData[class_value]["n_i"].get<uint64_t>();
-  n   = classJsonData[class_value]["n"].get<uint64_t>();
-  m   = classJsonData[class_value]["m"].get<uint64_t>();
-  p   = classJsonData[class_value]["p"].get<uint64_t>();
-  g   = classJsonData[class_value]["g"].get<uint64_t>();
+  if (Class != 0) {
+    selectClass(Class);
+  }
 
   return {startLine, endLine};
 }
 
-// Function to read specified lines from assembly file
-std::vector<std::string> readAssemblyLines(const std::string &assemblyFilePath, uint64_t startLine, uint64_t endLine) {
-  std::ifstream assemblyFileStream(assemblyFilePath);
-  if (!assemblyFileStream.is_open()) {
+// Function to map the assembly file and lex the code block into instructions
+void loadCodeBlock(const std::string &assemblyFilePath, uint64_t startLine, uint64_t endLine) {
+  if (!assemblySource.open(assemblyFilePath)) {
     throw std::runtime_error("Error: Fides commitmentGenerator cannot open " + assemblyFilePath + " for reading proposes.\n");
   }
 
-  std::vector<std::string> selectedLines;
-  std::string line;
-  uint64_t currentLineNumber = 1;
-
-  while (std::getline(assemblyFileStream, line)) {
-      if (currentLineNumber >= startLine && currentLineNumber <= endLine) {
-        selectedLines.push_back(line);
-      }
-      ++currentLineNumber;
-  }
-
-  assemblyFileStream.close();
-  
-  if (selectedLines.empty()) {
+  instructions = assemblySource.lex(startLine, endLine);
+  if (instructions.empty()) {
     throw std::runtime_error("Error: The code_block range contains blank lines. Please check the device_config.json file.");
   }
-
-  return selectedLines;
 }
 
 vector<vector<uint64_t>> vector_z(2, vector<uint64_t>(2, 0ll));
 
 // Function to modify assembly file content and save to new file
-void modifyAndSaveAssembly(const std::string &assemblyFilePath, const std::string &newAssemblyFile, uint64_t startLine, uint64_t endLine) {
-  std::ifstream assemblyFileStream(assemblyFilePath);
-  if (!assemblyFileStream.is_open()) {
-    throw std::runtime_error("Error: Fides commitmentGenerator cannot open " + assemblyFilePath + " for reading proposes.\n");
-  }
-
+void modifyAndSaveAssembly(const std::string &newAssemblyFile, uint64_t startLine, uint64_t endLine) {
   std::ofstream newAssemblyFileStream(newAssemblyFile);
   if (!newAssemblyFileStream.is_open()) {
     throw std::runtime_error("Error: Fides commitmentGenerator cannot open " + newAssemblyFile + " for writing proposes.\n");
   }
 
-  std::string line;
-  uint64_t currentLineNumber = 1;
-  uint64_t index = 0;
-  uint64_t z_arrayList = 0;
-
   vector<uint64_t> spaceSize(32, 8);
   vector<uint64_t> rdList;
-  while (std::getline(assemblyFileStream, line)) {
+  for (uint64_t currentLineNumber = 1; currentLineNumber <= assemblySource.lineCount(); ++currentLineNumber) {
+    string_view line = assemblySource.line(currentLineNumber);
     // Insert variables before the specified lines
     if (currentLineNumber == startLine) {
-      // newAssemblyFileStream << "bl store_register_instances\n";
       for (int i = 0; i < 31; i++) { // ARM has 32 general-purpose registers (r0 to r15)
-        newAssemblyFileStream <<  "      ldr x10, =x" + std::to_string(i) + "_array\n";  // Load address of x_array
-        newAssemblyFileStream << "      str x" + std::to_string(i) + ", [x10]\n";
+        newAssemblyFileStream << "      ldr x10, =x" << i << "_array\n";  // Load address of x_array
+        newAssemblyFileStream << "      str x" << i << ", [x10]\n";
       }
-      newAssemblyFileStream <<  "      ldr x10, =x31_array\n";  // Load address of x_array
-      newAssemblyFileStream <<  "      str x0, [x10]\n";
-      
-      newAssemblyFileStream << line << std::endl;
-      std::stringstream ss(line);
-      std::string opcode, rd, leftStr, rightStr;
-      ss >> opcode >> rd >> leftStr >> rightStr;
-      rd = Polynomial::trim(rd);
-      rd = Polynomial::removeCommas(rd);
-      instructions.push_back(line);
-      rdList.push_back(registerMap[rd]);
-      newAssemblyFileStream << "ldr x9, =x" << std::to_string(registerMap[rd]) << "_array" << endl;
-      if(registerMap[rd] == 31) {
-        newAssemblyFileStream << "str x0, [x9, #" << std::to_string(spaceSize[registerMap[rd]]) << "]" << endl;
-      }
-      else {
-        newAssemblyFileStream << "str x" << std::to_string(registerMap[rd]) << ", [x9, #" << std::to_string(spaceSize[registerMap[rd]]) << "]" << endl;
-      }
-      spaceSize[registerMap[rd]] += 8;
+      newAssemblyFileStream << "      ldr x10, =x31_array\n";  // Load address of x_array
+      newAssemblyFileStream << "      str x0, [x10]\n";
     }
-    else if (currentLineNumber > startLine && currentLineNumber <= endLine) {
-    newAssemblyFileStream << line << std::endl;
-
-    std::stringstream ss(line);
-    std::string opcode, rd, leftStr, rightStr;
-    ss >> opcode >> rd >> leftStr >> rightStr;
-
-    rd = Polynomial::trim(rd);
-    rd = Polynomial::removeCommas(rd);
-    instructions.push_back(line);
-    rdList.push_back(registerMap[rd]);
+    if (currentLineNumber >= startLine && currentLineNumber <= endLine) {
+      newAssemblyFileStream << line << '\n';
+      if (!circuit.recorded[currentLineNumber - startLine]) {
+        continue;  // the optimizer removed this gate
+      }
 
-    newAssemblyFileStream << "ldr x9, =x" << std::to_string(registerMap[rd]) << "_array" << endl;
+      uint64_t rd = instructions[currentLineNumber - startLine].rd;
+      rdList.push_back(rd);
 
+      newAssemblyFileStream << "ldr x9, =x" << rd << "_array\n";
 
-    // Compute the offset and handle large values
-    uint64_t offset = spaceSize[registerMap[rd]];
-    if (offset <= 2040) {
+      // Compute the offset and handle large values; sp/xzr record x0
+      uint64_t offset = spaceSize[rd];
+      uint64_t source = rd == noRegister ? 0 : rd;
+      if (offset <= 2040) {
         // Offset fits within 12-bit range
-      if(registerMap[rd] == 31) {
-        newAssemblyFileStream << "str x0, [x9, #" << offset << "]" << endl;
-      }
-      else {
-        newAssemblyFileStream << "str x" << std::to_string(registerMap[rd]) << ", [x9, #" << offset << "]" << endl;
+        newAssemblyFileStream << "str x" << source << ", [x9, #" << offset << "]\n";
+      } else {
+        // Offset exceeds 12-bit range
+        newAssemblyFileStream << "mov x10, " << offset << '\n';  // Load the offset into r1
+        newAssemblyFileStream << "add x10, x10, x9\n";           // Compute the effective address
+        newAssemblyFileStream << "str x" << source << ", [x10]\n";
       }
 
-    } else {
-        // Offset exceeds 12-bit range
-        newAssemblyFileStream << "mov x10, " << offset << endl;  // Load the offset into r1
-        newAssemblyFileStream << "add x10, x10, x9" << endl;      // Compute the effective address
-        if(registerMap[rd] == 31) {
-          newAssemblyFileStream << "str x0, [x10]" << endl;
-        }
-        else {
-          newAssemblyFileStream << "str x" << std::to_string(registerMap[rd]) << ", [x10]" << endl;
-        }
+      // Increment the space size for the next usage
+      spaceSize[rd] += 8;
     }
-
-    // Increment the space size for the next usage
-    spaceSize[registerMap[rd]] += 8;
-}
-
-
     else if (currentLineNumber == endLine + 1){
-      newAssemblyFileStream << "ldr x9, =z_array" << endl;
-      newAssemblyFileStream << "mov x10, #1" << endl;
-      newAssemblyFileStream << "str x10, [x9]" << endl;
+      newAssemblyFileStream << "ldr x9, =z_array\n";
+      newAssemblyFileStream << "mov x10, #1\n";
+      newAssemblyFileStream << "str x10, [x9]\n";
 
       for(uint64_t i = 0; i < n_i - 1; i++) { // for CPUs with 31 reg
-        newAssemblyFileStream << "ldr x9, =z_array" << endl;
-        newAssemblyFileStream << "ldr x10, =x" << std::to_string(i) << "_array" << endl;
-        newAssemblyFileStream << "ldr x11, [x10]" << endl;
-        newAssemblyFileStream << "str x11, [x9, #" << std::to_string((i+1)*8) << "]" << endl;
+        newAssemblyFileStream << "ldr x9, =z_array\n";
+        newAssemblyFileStream << "ldr x10, =x" << i << "_array\n";
+        newAssemblyFileStream << "ldr x11, [x10]\n";
+        newAssemblyFileStream << "str x11, [x9, #" << (i+1)*8 << "]\n";
       }
       
-      newAssemblyFileStream << "ldr x9, =z_array" << endl;
-      newAssemblyFileStream << "mov x10, #1" << endl;
-      newAssemblyFileStream << "str x10, [x9, #256]" << endl;
+      newAssemblyFileStream << "ldr x9, =z_array\n";
+      newAssemblyFileStream << "mov x10, #1\n";
+      newAssemblyFileStream << "str x10, [x9, #256]\n";
 
       vector<uint64_t> spaceSizeZ(32, 8);
-      vector<uint64_t> yList;
       
-      for (uint64_t i = 0; i < n_g; i++) {
+      for (uint64_t i = 0; i < rdList.size(); i++) {
         spaceSizeZ[rdList[i]] += 8;
-        newAssemblyFileStream << "ldr x9, =z_array" << endl;
-        newAssemblyFileStream << "ldr x10, =x" << std::to_string(rdList[i]) << "_array" << endl;
+        newAssemblyFileStream << "ldr x9, =z_array\n";
+        newAssemblyFileStream << "ldr x10, =x" << rdList[i] << "_array\n";
 
         // Compute effective address for large offsetLW in z_array
         uint64_t offsetLW = spaceSizeZ[rdList[i]] - 8;
         if (offsetLW <= 2040) {
-          newAssemblyFileStream << "ldr x11, [x10, #" << offsetLW << "]" << endl;
+          newAssemblyFileStream << "ldr x11, [x10, #" << offsetLW << "]\n";
         } else {
-          newAssemblyFileStream << "mov x16, #" << offsetLW << endl;  // Load offsetLW into r3
-          newAssemblyFileStream << "add x16, x16, x10" << endl;         // Compute the effective address
-          newAssemblyFileStream << "ldr x11, [x16]" << endl;          // Load the value
+          newAssemblyFileStream << "mov x16, #" << offsetLW << '\n';  // Load offsetLW into r3
+          newAssemblyFileStream << "add x16, x16, x10\n";             // Compute the effective address
+          newAssemblyFileStream << "ldr x11, [x16]\n";                // Load the value
         }
 
         uint64_t offset = (n_i + i + 1) * 8;
         if (offset <= 2040) {
-          newAssemblyFileStream << "str x11, [x9, #" << offset << "]" << endl;
+          newAssemblyFileStream << "str x11, [x9, #" << offset << "]\n";
         } else {
           // Offset exceeds 12-bit range, use temporary register
-          newAssemblyFileStream << "mov x16, #" << offset << endl;    // Load offset into r3  
-          newAssemblyFileStream << "add x16, x16, x9" << endl;        // Compute effective address  
-          newAssemblyFileStream << "str x11, [x16]" << endl;          // Store value at effective address  
+          newAssemblyFileStream << "mov x16, #" << offset << '\n';    // Load offset into r3  
+          newAssemblyFileStream << "add x16, x16, x9\n";              // Compute effective address  
+          newAssemblyFileStream << "str x11, [x16]\n";                // Store value at effective address  
         }
       }
 
       newAssemblyFileStream << "bl proofGenerator\n";
-      newAssemblyFileStream << line << std::endl;
+      newAssemblyFileStream << line << '\n';
     }
     else {
-      newAssemblyFileStream << line << std::endl;
+      newAssemblyFileStream << line << '\n';
     }
-
-    ++currentLineNumber;
   }
 
   std::string assemblyCode = ".section .data\n";
@@ -314,39 +289,176 @@ void modifyAndSaveAssembly(const std::string &assemblyFilePath, const std::strin
 
   newAssemblyFileStream << assemblyCode << std::endl;
 
-  assemblyFileStream.close();
   newAssemblyFileStream.close();
 }
 
 
-void commitmentGenerator() {
-  setupFilePath = "data/setup";
-  setupFilePath += to_string(Class);
-  setupFilePath += ".json";
-  std::ifstream setupFileStream(setupFilePath);
-  if (!setupFileStream.is_open()) {
-    throw std::runtime_error("Error: Fides commitmentGenerator cannot open " + setupFilePath + " for reading proposes.\n");
+// Function to pick the register the direct instrumentation keeps the z_array
+// pointer in: the highest of x19..x28 the code block does not mention
+int chooseBaseRegister() {
+  uint32_t used = 0;
+  for (const auto &instruction : instructions) {
+    used |= instruction.registersUsed;
+  }
+  for (int i = 28; i >= 19; i--) {
+    if (!(used & (1u << i))) {
+      return i;
+    }
+  }
+  throw std::runtime_error("Error: Fides commitmentGenerator needs one of x19..x28 to be unused in the code_block for the direct instrumentation.\n");
+}
+
+// Function to modify assembly file content and save to new file, writing each
+// destination register straight into its final z_array slot.
+//
+// z_array = [1, x0..x30, 1, gate outputs...]. The two constant slots are
+// initialised in .data; the registers are stored with stp pairs at zkp start,
+// then the base register is moved to the first gate slot and every instruction
+// of the block is followed by a single post-increment store. The base
+// register's own value is saved through the stack and restored from z_array
+// before proofGenerator is called, so the program sees no clobbered register.
+void modifyAndSaveAssemblyDirect(const std::string &newAssemblyFile, uint64_t startLine, uint64_t endLine) {
+  int base = chooseBaseRegister();
+  std::string baseName = "x" + std::to_string(base);
+
+  std::ofstream newAssemblyFileStream(newAssemblyFile);
+  if (!newAssemblyFileStream.is_open()) {
+    throw std::runtime_error("Error: Fides commitmentGenerator cannot open " + newAssemblyFile + " for writing proposes.\n");
+  }
+
+  uint64_t addedInstructions = 0;
+  for (uint64_t currentLineNumber = 1; currentLineNumber <= assemblySource.lineCount(); ++currentLineNumber) {
+    string_view line = assemblySource.line(currentLineNumber);
+    if (currentLineNumber == startLine) {
+      newAssemblyFileStream << "str " << baseName << ", [sp, #-16]!\n";
+      newAssemblyFileStream << "adrp " << baseName << ", z_array\n";
+      newAssemblyFileStream << "add " << baseName << ", " << baseName << ", :lo12:z_array\n";
+      addedInstructions += 3;
+      // Register xi goes to z_array[i + 1]
+      for (int i = 0; i < 31; i++) {
+        if (i == base) {
+          continue;
+        }
+        if (i + 1 < 31 && i + 1 != base) {
+          newAssemblyFileStream << "stp x" << i << ", x" << i + 1 << ", [" << baseName << ", #" << (i + 1) * 8 << "]\n";
+          i++;
+        } else {
+          newAssemblyFileStream << "str x" << i << ", [" << baseName << ", #" << (i + 1) * 8 << "]\n";
+        }
+        addedInstructions++;
+      }
+      int scratch = base == 0 ? 1 : 0;
+      newAssemblyFileStream << "ldr x" << scratch << ", [sp], #16\n";
+      newAssemblyFileStream << "str x" << scratch << ", [" << baseName << ", #" << (base + 1) * 8 << "]\n";
+      newAssemblyFileStream << "ldr x" << scratch << ", [" << baseName << ", #" << (scratch + 1) * 8 << "]\n";
+      newAssemblyFileStream << "add " << baseName << ", " << baseName << ", #" << (n_i + 1) * 8 << '\n';
+      addedInstructions += 4;
+    }
+    if (currentLineNumber >= startLine && currentLineNumber <= endLine) {
+      newAssemblyFileStream << line << '\n';
+      if (!circuit.recorded[currentLineNumber - startLine]) {
+        continue;  // the optimizer removed this gate
+      }
+
+      // Same value the array instrumentation records for sp/xzr
+      uint8_t rd = instructions[currentLineNumber - startLine].rd;
+      newAssemblyFileStream << "str x" << (rd == noRegister ? 0 : int(rd)) << ", [" << baseName << "], #8\n";
+      addedInstructions++;
+    }
+    else if (currentLineNumber == endLine + 1) {
+      newAssemblyFileStream << "adrp " << baseName << ", z_array\n";
+      newAssemblyFileStream << "add " << baseName << ", " << baseName << ", :lo12:z_array\n";
+      newAssemblyFileStream << "ldr " << baseName << ", [" << baseName << ", #" << (base + 1) * 8 << "]\n";
+      newAssemblyFileStream << "bl proofGenerator\n";
+      newAssemblyFileStream << line << '\n';
+      addedInstructions += 4;
+    }
+    else {
+      newAssemblyFileStream << line << '\n';
+    }
+  }
+
+  std::string assemblyCode = ".section .data\n";
+  assemblyCode += ".align 3\n";
+  assemblyCode += ".global z_array\nz_array:    .quad 1\n";
+  assemblyCode += "    .space " + std::to_string((n_i - 1) * 8) + "\n";
+  assemblyCode += "    .quad 1\n";
+  assemblyCode += "    .space " + std::to_string(n_g * 8) + "\n";
+  newAssemblyFileStream << assemblyCode << std::endl;
+
+  newAssemblyFileStream.close();
+
+  cout << "Direct instrumentation: base register " << baseName << ", " << addedInstructions << " instructions added" << endl;
+}
+
+// Function to hash everything the commitment and param files depend on: the
+// code block as normalised instructions (no line numbers, spacing or comments),
+// the device fields, the optimizer, the class and the setup. ck[i] = g * tau^i,
+// so p, g, vk = g * tau and the degree identify the setup without reading ck.
+std::string codeBlockHash(const nlohmann::json &config, uint64_t degree, uint64_t vk) {
+  std::stringstream key;
+  key << "fides-commitment-v1\n";
+  for (const auto &instruction : instructions) {
+    key << instruction.mnemonic << ' ' << int(instruction.rd);
+    for (const Operand *operand : {&instruction.left, &instruction.right}) {
+      if (operand->kind == Operand::Kind::Register) {
+        key << " x" << int(operand->reg);
+      } else if (operand->kind == Operand::Kind::Immediate) {
+        key << " #" << operand->immediate;
+      } else if (operand->kind == Operand::Kind::Unknown) {
+        key << ' ' << operand->text;
+      }
+    }
+    key << '\n';
+  }
+  nlohmann::json device = config;
+  device.erase("code_block");
+  device.erase("instrumentation");
+  device.erase("cache");
+  key << device.dump() << '\n';
+  key << "optimize " << optimizeGates << '\n';
+  key << "class " << Class << ' ' << n_g << ' ' << n_i << ' ' << n << ' ' << m << ' ' << p << ' ' << g << '\n';
+  key << "setup " << degree << ' ' << vk << '\n';
+  std::string keyString = key.str();
+  return Polynomial::SHA256(const_cast<char*>(keyString.c_str()));
+}
+
+// Function to copy the cached commitment and param files of a hash into place
+bool restoreFromCache(const std::string &hash) {
+  std::filesystem::path entry = std::filesystem::path(cacheDirectory) / hash;
+  std::error_code error;
+  if (!std::filesystem::exists(entry / "commitment.json", error) || !std::filesystem::exists(entry / "param.json", error)) {
+    return false;
   }
-  nlohmann::json setupJsonData;
-  setupFileStream >> setupJsonData;
-  setupFileStream.close();
-  vector<uint64_t> ck = setupJsonData["ck"].get<vector<uint64_t>>();
-  uint64_t vk = setupJsonData["vk"].get<uint64_t>();
+  auto overwrite = std::filesystem::copy_options::overwrite_existing;
+  return std::filesystem::copy_file(entry / "param.json", paramFileName, overwrite, error) &&
+         std::filesystem::copy_file(entry / "commitment.json", commitmentFileName, overwrite, error);
+}
+
+// Function to keep the files just generated under their hash. The commitment
+// is copied last, so an entry is only complete once it is there.
+void storeInCache(const std::string &hash) {
+  std::filesystem::path entry = std::filesystem::path(cacheDirectory) / hash;
+  std::error_code error;
+  auto overwrite = std::filesystem::copy_options::overwrite_existing;
+  if (!std::filesystem::create_directories(entry, error) && error) {
+    cerr << "Warning: cannot create " << entry.string() << ": " << error.message() << endl;
+    return;
+  }
+  if (!std::filesystem::copy_file(paramFileName, entry / "param.json", overwrite, error) ||
+      !std::filesystem::copy_file(commitmentFileName, entry / "commitment.json", overwrite, error)) {
+    cerr << "Warning: cannot store the commitment in " << entry.string() << ": " << error.message() << endl;
+  }
+}
+
+void commitmentGenerator(const CommitmentKey &ck) {
+  uint64_t vk = ck.vk;
 
   
 
 
- for (const auto& instr : instructions) {
-    std::stringstream ss(instr);
-    std::string opcode, rd, leftStr, rightStr;
-    
-    ss >> opcode >> rd;
-    ss >> leftStr >> rightStr;
-    leftStr = Polynomial::trim(leftStr);
-    rightStr = Polynomial::trim(rightStr);
-    leftStr = Polynomial::removeCommas(leftStr);
-    rightStr = Polynomial::removeCommas(rightStr);
-    cout << "opcode: " << opcode << "\tleftStr: " << leftStr << "\trightStr: " << rightStr << "\n";
+ for (const auto& instruction : instructions) {
+    FIDES_LOG(LogLevel::Debug, "opcode: " << instruction.mnemonic << "\tleftStr: " << instruction.left.text << "\trightStr: " << instruction.right.text);
   }
   cout << "Number of immediate instructions (n_i): " << n_i << endl;
   cout << "Number of general instructions (n_g): " << n_g << endl;
@@ -363,105 +475,19 @@ void commitmentGenerator() {
   vector<vector<uint64_t>> B(n, vector<uint64_t>(n, 0ll));
   vector<vector<uint64_t>> C(n, vector<uint64_t>(n, 0ll));
 
-  vector<uint64_t> rd_latest_used(32, 0);
-
-  // Fill matrices based on the instructions
+  // Fill matrices based on the circuit; rows the optimizer freed stay
+  // 0 * 0 = z[row] with z[row] left at 0 by the instrumentation
   for (uint64_t i = 0; i < n_g; i++) {
-    std::stringstream ss(instructions[i]);
-    std::string opcode, rd, leftStr, rightStr;
-    ss >> opcode >> rd;
-    uint64_t li = 0;
-    uint64_t ri = 0;
-
-    if (opcode == "add" || opcode == "addi" || opcode == "mul") {
-      ss >> leftStr >> rightStr;
-
-      // Remove commas
-      rd = Polynomial::removeCommas(rd);
-      leftStr = Polynomial::removeCommas(leftStr);
-      rightStr = Polynomial::removeCommas(rightStr);
-      // Trim spaces
-      rd = Polynomial::trim(rd);
-      leftStr = Polynomial::trim(leftStr);
-      rightStr = Polynomial::trim(rightStr);
-
-      uint64_t leftInt, rightInt;
-      
-      C[1+n_i+i][1+n_i+i] = 1;
-
-      if (opcode == "add" || opcode == "addi") {
-        A[1+n_i+i][0] = 1;
-        // if (std::isdigit(leftStr[0])) {
-          // leftInt = std::stoi(leftStr);
-        if (std::isdigit(leftStr[0]) || (leftStr[0] == '#' && leftStr.size() > 1 && std::isdigit(leftStr[1]))) {
-          leftInt = std::stoi(leftStr[0] == '#' ? leftStr.substr(1) : leftStr);
-          B[1+n_i+i][0] = leftInt;
-        }
-        else {
-          if(rd_latest_used[registerMap[leftStr]] == 0){
-            li = (registerMap[leftStr] + 1);
-          }
-          else {
-            li = rd_latest_used[registerMap[leftStr]];
-          }
-          B[1+n_i+i][li] = 1;
-        }
-        // if(std::isdigit(rightStr[0])){
-        //   rightInt = std::stoi(rightStr);
-        
-        if (std::isdigit(rightStr[0]) || (rightStr[0] == '#' && rightStr.size() > 1 && std::isdigit(rightStr[1]))) {
-          rightInt = std::stoi(rightStr[0] == '#' ? rightStr.substr(1) : rightStr);
-          B[1+n_i+i][0] = rightInt;
-        }
-        else {
-          if(rd_latest_used[registerMap[rightStr]] == 0){
-            ri = (registerMap[rightStr] + 1);
-          }
-          else {
-            ri = rd_latest_used[registerMap[rightStr]];
-          }
-          B[1+n_i+i][ri] = 1;
-        }
-
-    } else if (opcode == "mul") {
-        // if (std::isdigit(leftStr[0])) {
-        //   leftInt = std::stoi(leftStr);
-        if (std::isdigit(leftStr[0]) || (leftStr[0] == '#' && leftStr.size() > 1 && std::isdigit(leftStr[1]))) {
-          leftInt = std::stoi(leftStr[0] == '#' ? leftStr.substr(1) : leftStr);
-          
-          A[1+n_i+i][0] = leftInt;
-        }
-        else {
-          if(rd_latest_used[registerMap[leftStr]] == 0){
-            li = (registerMap[leftStr] + 1);
-          }
-          else {
-            li = rd_latest_used[registerMap[leftStr]];
-          }
-          A[1+n_i+i][li] = 1;
-        }
-        // if (std::isdigit(rightStr[0])) {
-        //   rightInt = std::stoi(rightStr);
-        if (std::isdigit(rightStr[0]) || (rightStr[0] == '#' && rightStr.size() > 1 && std::isdigit(rightStr[1]))) {
-          rightInt = std::stoi(rightStr[0] == '#' ? rightStr.substr(1) : rightStr);
-          
-          B[1+n_i+i][0] = rightInt;
-        }
-        else {
-          if(rd_latest_used[registerMap[rightStr]] == 0){
-            ri = (registerMap[rightStr] + 1);
-          }
-          else {
-            ri = rd_latest_used[registerMap[rightStr]];
-          }
-          B[1+n_i+i][ri] = 1;
-        }
-      }
-      rd_latest_used[registerMap[rd]] = (1 + n_i + i);
+    uint64_t row = 1 + n_i + i;
+    C[row][row] = 1;
+    if (i >= circuit.gates.size()) {
+      continue;
     }
-    
-    else {
-      throw std::runtime_error("Error: Fides commitmentGenerator program cannot recognize the opcode << " + opcode + " >> within the specified code_block range. The code_block range is defined in the device_config.json file.\n");
+    for (const auto &term : circuit.gates[i].a) {
+      A[row][circuit.column(term)] = term.coefficient;
+    }
+    for (const auto &term : circuit.gates[i].b) {
+      B[row][circuit.column(term)] = term.coefficient;
     }
   }
 
@@ -479,11 +505,14 @@ void commitmentGenerator() {
   for (uint64_t i = 1; i < n; i++) {
     H.push_back(Polynomial::power(w, i, p));
   }
-  cout << "H[n]: ";
-  for (uint64_t i = 0; i < n; i++) {
-    cout << H[i] << " ";
+  DebugDump::instance().write("H", H);
+  if (logEnabled(LogLevel::Debug)) {
+    cout << "H[n]: ";
+    for (uint64_t i = 0; i < n; i++) {
+      cout << H[i] << " ";
+    }
+    cout << endl;
   }
-  cout << endl;
 
   uint64_t y, g_m;
 
@@ -495,11 +524,14 @@ void commitmentGenerator() {
   for (uint64_t i = 1; i < m; i++) {
     K.push_back(Polynomial::power(y, i, p));
   }
-  cout << "K[m]: ";
-  for (uint64_t i = 0; i < m; i++) {
-    cout << K[i] << " ";
+  DebugDump::instance().write("K", K);
+  if (logEnabled(LogLevel::Debug)) {
+    cout << "K[m]: ";
+    for (uint64_t i = 0; i < m; i++) {
+      cout << K[i] << " ";
+    }
+    cout << endl;
   }
-  cout << endl;
   
   // Create a polynomial vector vH_x of size (n + 1) initialized to 0
   vector<uint64_t> vH_x(n + 1, 0);
@@ -728,18 +760,63 @@ int main(int argc, char* argv[]) {
   nlohmann::json config;
   auto [startLine, endLine] = parseDeviceConfig(configFilePath, config);
 
-  if((endLine - startLine)+1 != n_g) {
-    throw std::runtime_error(
-      "Error: The 'code_block' range in device_config.json does not match the number of supported instructions (n_g) for the selected 'class'. "
-      "Please verify the 'code_block' and 'class' values in device_config.json."
-    );
-  }
-    
   cout << "startLine: " << startLine << endl;
   cout << "endLine: " << endLine << endl;
   
-  modifyAndSaveAssembly(assemblyFilePath, newAssemblyFile, startLine, endLine);
-  commitmentGenerator();
+  loadCodeBlock(assemblyFilePath, startLine, endLine);
+
+  // The gate count decides the class, and the class's p is needed to build the
+  // circuit; n_i is the same in every class, so start from the class that fits
+  // every instruction and narrow it down once the circuit is known
+  bool automaticClass = Class == 0;
+  if (automaticClass) {
+    selectClass(smallestClass(instructions.size()));
+  }
+  OptimizerReport report;
+  for (int pass = 0; pass < 2; pass++) {
+    circuit = buildCircuit(instructions, n_i, p);
+    if (optimizeGates) {
+      report = optimizeCircuit(circuit);
+    }
+    if (!automaticClass || smallestClass(circuit.gates.size()) == Class) {
+      break;
+    }
+    selectClass(smallestClass(circuit.gates.size()));
+  }
+  if (optimizeGates) {
+    cout << "Circuit optimizer: " << report.gatesBefore << " gates -> " << report.gatesAfter << " gates ("
+         << report.gatesBefore - report.gatesAfter << " saved: " << report.folded << " folded, "
+         << report.merged << " merged, " << report.dead << " dead)" << endl;
+  }
+  if (circuit.gates.size() > n_g) {
+    throw std::runtime_error(
+      "Error: The 'code_block' range in device_config.json has " + to_string(circuit.gates.size()) + " gates, more than the " + to_string(n_g) + " (n_g) the selected 'class' supports. "
+      "Please verify the 'code_block' and 'class' values in device_config.json, or remove 'class' to select it automatically."
+    );
+  }
+  cout << (automaticClass ? "Selected class " : "Class ") << Class << ": " << circuit.gates.size() << " gates, "
+       << n_g - circuit.gates.size() << " padding rows" << endl;
+
+  if (instrumentationMode == "direct") {
+    modifyAndSaveAssemblyDirect(newAssemblyFile, startLine, endLine);
+  } else {
+    modifyAndSaveAssembly(newAssemblyFile, startLine, endLine);
+  }
+
+  // The rewritten assembly depends on where the block sits in program.s, so it
+  // is always regenerated; the commitment and param files only on a cache miss,
+  // which is also the only time the whole ck is loaded
+  uint64_t degree = ahpDegree(n_g, n_i);
+  std::string hash = codeBlockHash(config, degree, loadSetupVk(Class, p, g, degree));
+  cout << "Code block hash: " << hash << endl;
+  if (useCache && restoreFromCache(hash)) {
+    cout << "Cache hit: " << commitmentFileName << " and " << paramFileName << " are restored from " << cacheDirectory << "/" << hash << endl;
+  } else {
+    commitmentGenerator(loadCommitmentKey(Class, p, g, degree));
+    if (useCache) {
+      storeInCache(hash);
+    }
+  }
   cout << newAssemblyFile << " is created successfully\n";
   return 0;
 }
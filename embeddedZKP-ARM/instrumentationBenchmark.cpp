@@ -0,0 +1,242 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the run time of a code block of GATES mul/add instructions with the
+// same block instrumented the way commitmentGenerator does it: "arrays" (one
+// array per register plus the copy into z_array) and "direct" (post-increment
+// stores straight into z_array). The call to proofGenerator is left out since
+// it is the same in both modes. Before timing, both modes must record the same
+// witness in their z_array. Runs on the IOT2050 (aarch64) only:
+// `g++ -std=c++17 -O2 -no-pie instrumentationBenchmark.cpp -o instrumentationBenchmark`
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#define GATES 16
+#define STRINGIFY(x) #x
+#define TOSTRING(x) STRINGIFY(x)
+
+#if defined(__aarch64__)
+
+using namespace std::chrono;
+
+// Registers x0..x30 plus the x31 array, the same symbols the arrays mode adds
+asm(".pushsection .data\n"
+    ".align 3\n"
+    ".irp i, 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31\n"
+    "bench_x\\i\\()_array: .space 8 * (" TOSTRING(GATES) " + 1)\n"
+    ".endr\n"
+    ".global bench_z_arrays\n"
+    "bench_z_arrays: .space 8 * (32 + " TOSTRING(GATES) " + 1)\n"
+    ".global bench_z_direct\n"
+    "bench_z_direct: .quad 1\n"
+    "    .space 248\n"
+    "    .quad 1\n"
+    "    .space 8 * " TOSTRING(GATES) "\n"
+    ".popsection\n");
+
+__attribute__((noinline)) uint64_t blockOriginal(uint64_t a, uint64_t b) {
+  uint64_t out;
+  asm volatile(
+    "mov x1, %[a]\n"
+    "mov x2, %[b]\n"
+    ".rept " TOSTRING(GATES) " / 2\n"
+    "mul x1, x1, x2\n"
+    "add x1, x1, #3\n"
+    ".endr\n"
+    "mov %[out], x1\n"
+    : [out] "=r" (out)
+    : [a] "r" (a), [b] "r" (b)
+    : "x1", "x2", "memory");
+  return out;
+}
+
+__attribute__((noinline)) uint64_t blockArrays(uint64_t a, uint64_t b) {
+  uint64_t out;
+  asm volatile(
+    "mov x1, %[a]\n"
+    "mov x2, %[b]\n"
+    ".irp i, 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30\n"
+    "ldr x10, =bench_x\\i\\()_array\n"
+    "str x\\i, [x10]\n"
+    ".endr\n"
+    "ldr x10, =bench_x31_array\n"
+    "str x0, [x10]\n"
+    ".set bench_offset, 8\n"
+    ".rept " TOSTRING(GATES) " / 2\n"
+    "mul x1, x1, x2\n"
+    "ldr x9, =bench_x1_array\n"
+    "str x1, [x9, #bench_offset]\n"
+    ".set bench_offset, bench_offset + 8\n"
+    "add x1, x1, #3\n"
+    "ldr x9, =bench_x1_array\n"
+    "str x1, [x9, #bench_offset]\n"
+    ".set bench_offset, bench_offset + 8\n"
+    ".endr\n"
+    // Copy epilogue
+    "ldr x9, =bench_z_arrays\n"
+    "mov x10, #1\n"
+    "str x10, [x9]\n"
+    ".irp i, 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30\n"
+    "ldr x9, =bench_z_arrays\n"
+    "ldr x10, =bench_x\\i\\()_array\n"
+    "ldr x11, [x10]\n"
+    "str x11, [x9, #(\\i + 1) * 8]\n"
+    ".endr\n"
+    "ldr x9, =bench_z_arrays\n"
+    "mov x10, #1\n"
+    "str x10, [x9, #256]\n"
+    ".set bench_offset, 8\n"
+    ".rept " TOSTRING(GATES) "\n"
+    "ldr x9, =bench_z_arrays\n"
+    "ldr x10, =bench_x1_array\n"
+    "ldr x11, [x10, #bench_offset]\n"
+    "str x11, [x9, #256 + bench_offset]\n"
+    ".set bench_offset, bench_offset + 8\n"
+    ".endr\n"
+    "mov %[out], x1\n"
+    "b 1f\n"
+    ".ltorg\n"
+    "1:\n"
+    : [out] "=r" (out)
+    : [a] "r" (a), [b] "r" (b)
+    : "x1", "x2", "x9", "x10", "x11", "memory");
+  return out;
+}
+
+__attribute__((noinline)) uint64_t blockDirect(uint64_t a, uint64_t b) {
+  uint64_t out;
+  asm volatile(
+    "mov x1, %[a]\n"
+    "mov x2, %[b]\n"
+    "str x27, [sp, #-16]!\n"
+    "adrp x27, bench_z_direct\n"
+    "add x27, x27, :lo12:bench_z_direct\n"
+    "stp x0, x1, [x27, #8]\n"
+    "stp x2, x3, [x27, #24]\n"
+    "stp x4, x5, [x27, #40]\n"
+    "stp x6, x7, [x27, #56]\n"
+    "stp x8, x9, [x27, #72]\n"
+    "stp x10, x11, [x27, #88]\n"
+    "stp x12, x13, [x27, #104]\n"
+    "stp x14, x15, [x27, #120]\n"
+    "stp x16, x17, [x27, #136]\n"
+    "stp x18, x19, [x27, #152]\n"
+    "stp x20, x21, [x27, #168]\n"
+    "stp x22, x23, [x27, #184]\n"
+    "stp x24, x25, [x27, #200]\n"
+    "str x26, [x27, #216]\n"
+    "stp x28, x29, [x27, #232]\n"
+    "str x30, [x27, #248]\n"
+    "ldr x0, [sp], #16\n"
+    "str x0, [x27, #224]\n"
+    "ldr x0, [x27, #8]\n"
+    "add x27, x27, #264\n"
+    ".rept " TOSTRING(GATES) " / 2\n"
+    "mul x1, x1, x2\n"
+    "str x1, [x27], #8\n"
+    "add x1, x1, #3\n"
+    "str x1, [x27], #8\n"
+    ".endr\n"
+    "adrp x27, bench_z_direct\n"
+    "add x27, x27, :lo12:bench_z_direct\n"
+    "ldr x27, [x27, #224]\n"
+    "mov %[out], x1\n"
+    : [out] "=r" (out)
+    : [a] "r" (a), [b] "r" (b)
+    : "x1", "x2", "x27", "memory");
+  return out;
+}
+
+extern "C" uint64_t bench_z_arrays[], bench_z_direct[];
+
+// Function to check that both modes record the same witness for one run of the
+// block: the constant slots, the block's inputs x1 and x2, and every gate. The
+// other register slots hold whatever the caller left there (and x10 is scratch
+// in the arrays mode), so they are not compared.
+bool sameWitness(uint64_t a, uint64_t b) {
+  blockArrays(a, b);
+  blockDirect(a, b);
+  bool same = true;
+  const int inputSlots[] = { 0, 1 + 1, 1 + 2, 32 };
+  for (int slot : inputSlots) {
+    same = same && bench_z_arrays[slot] == bench_z_direct[slot];
+  }
+  for (int gate = 0; gate < GATES; gate++) {
+    same = same && bench_z_arrays[33 + gate] == bench_z_direct[33 + gate];
+  }
+  return same && bench_z_direct[2] == a && bench_z_direct[3] == b;
+}
+
+// Function to time one variant; returns nanoseconds per execution of the block
+double timeBlock(uint64_t (*block)(uint64_t, uint64_t), int rounds, uint64_t& result) {
+  uint64_t sum = 0;
+  auto start = steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    sum += block(uint64_t(i), 5);
+  }
+  auto stop = steady_clock::now();
+  result = sum;
+  return duration<double, std::nano>(stop - start).count() / rounds;
+}
+
+int main(int argc, char* argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 1000000;
+
+  const std::pair<const char*, uint64_t (*)(uint64_t, uint64_t)> variants[] = {
+    {"original", blockOriginal},
+    {"arrays", blockArrays},
+    {"direct", blockDirect}
+  };
+
+  for (uint64_t a : { 0, 7, 123456789 }) {
+    if (!sameWitness(a, 5)) {
+      std::cerr << "arrays and direct recorded different witnesses for x1 = " << a << std::endl;
+      return 1;
+    }
+  }
+
+  double baseline = 0;
+  uint64_t expected = 0;
+  std::cout << GATES << " gates, " << rounds << " rounds" << std::endl;
+  std::cout << "mode       ns/block  overhead" << std::endl;
+  for (const auto& variant : variants) {
+    uint64_t result;
+    timeBlock(variant.second, rounds / 10 + 1, result);  // warm up
+    double ns = timeBlock(variant.second, rounds, result);
+    if (variant.second == blockOriginal) {
+      baseline = ns;
+      expected = result;
+    } else if (result != expected) {
+      std::cerr << variant.first << " changed the result of the block" << std::endl;
+      return 1;
+    }
+    std::cout << std::left << std::setw(10) << variant.first << " "
+              << std::right << std::setw(8) << std::fixed << std::setprecision(1) << ns << "  "
+              << std::setw(7) << std::setprecision(2) << ns / baseline << "x" << std::endl;
+  }
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cerr << "instrumentationBenchmark runs the instrumented assembly and needs an aarch64 device." << std::endl;
+  return 1;
+}
+
+#endif
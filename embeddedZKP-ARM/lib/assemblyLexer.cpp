@@ -0,0 +1,225 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "assemblyLexer.h"
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int registerIndex(string_view name) {
+  if (name.size() < 2 || name.size() > 3) {
+    return -1;
+  }
+  char first = name[0];
+  if (name[1] >= '0' && name[1] <= '9') {
+    int number = name[1] - '0';
+    if (name.size() == 3) {
+      if (number == 0 || name[2] < '0' || name[2] > '9') {
+        return -1;
+      }
+      number = number * 10 + (name[2] - '0');
+    }
+    switch (first) {
+      case 'x':
+      case 'w':
+        return number <= 30 ? number : -1;
+      case 'r':
+        return number <= 15 ? number : -1;
+      default:
+        return -1;
+    }
+  }
+  if (name.size() == 2) {
+    switch (first) {
+      case 's': return name[1] == 'p' ? 31 : -1;
+      case 'l': return name[1] == 'r' ? 14 : -1;
+      case 'p': return name[1] == 'c' ? 15 : -1;
+      default: return -1;
+    }
+  }
+  return (first == 'x' || first == 'w') && name[1] == 'z' && name[2] == 'r' ? 31 : -1;
+}
+
+bool parseImmediate(string_view token, int64_t& value) {
+  if (!token.empty() && token[0] == '#') {
+    token.remove_prefix(1);
+  }
+  bool negative = !token.empty() && token[0] == '-';
+  if (negative) {
+    token.remove_prefix(1);
+  }
+  if (token.empty() || token[0] < '0' || token[0] > '9') {
+    return false;
+  }
+  int base = 10;
+  if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')) {
+    token.remove_prefix(2);
+    base = 16;
+  }
+  uint64_t magnitude = 0;
+  auto result = from_chars(token.data(), token.data() + token.size(), magnitude, base);
+  if (result.ec != errc() || result.ptr != token.data() + token.size()) {
+    return false;
+  }
+  value = negative ? -int64_t(magnitude) : int64_t(magnitude);
+  return true;
+}
+
+// Function to get the next token; commas, brackets, '!' and blanks separate tokens
+static string_view nextToken(string_view& rest) {
+  auto separator = [](char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == '[' || c == ']' || c == '!' || c == '\r';
+  };
+  size_t begin = 0;
+  while (begin < rest.size() && separator(rest[begin])) {
+    begin++;
+  }
+  size_t end = begin;
+  while (end < rest.size() && !separator(rest[end])) {
+    end++;
+  }
+  string_view token = rest.substr(begin, end - begin);
+  rest.remove_prefix(end);
+  return token;
+}
+
+static Operand classify(string_view token) {
+  Operand operand;
+  operand.text = token;
+  if (token.empty()) {
+    return operand;
+  }
+  int index = registerIndex(token);
+  if (index >= 0) {
+    operand.kind = Operand::Kind::Register;
+    operand.reg = uint8_t(index);
+  } else if (parseImmediate(token, operand.immediate)) {
+    operand.kind = Operand::Kind::Immediate;
+  } else {
+    operand.kind = Operand::Kind::Unknown;
+  }
+  return operand;
+}
+
+AssemblyInstruction lexInstruction(string_view line, uint64_t lineNumber) {
+  AssemblyInstruction instruction;
+  instruction.line = lineNumber;
+  instruction.text = line;
+
+  string_view rest = line.substr(0, line.find("//"));
+  instruction.mnemonic = nextToken(rest);
+  if (instruction.mnemonic == "add" || instruction.mnemonic == "addi") {
+    instruction.opcode = Opcode::Add;
+  } else if (instruction.mnemonic == "mul") {
+    instruction.opcode = Opcode::Mul;
+  }
+
+  Operand* operands[] = { nullptr, &instruction.left, &instruction.right };
+  for (int position = 0; !rest.empty(); position++) {
+    string_view token = nextToken(rest);
+    if (token.empty()) {
+      break;
+    }
+    Operand operand = classify(token);
+    if (operand.kind == Operand::Kind::Register && operand.reg < 31) {
+      instruction.registersUsed |= 1u << operand.reg;
+    }
+    if (position == 0) {
+      instruction.rd = operand.kind == Operand::Kind::Register ? operand.reg : noRegister;
+    } else if (position < 3) {
+      *operands[position] = operand;
+    }
+  }
+  return instruction;
+}
+
+AssemblySource::~AssemblySource() {
+  close();
+}
+
+// Function to unmap the file and forget its lines
+void AssemblySource::close() {
+  if (data) {
+    munmap(const_cast<char*>(data), size);
+  }
+  data = nullptr;
+  size = 0;
+  lineStarts.clear();
+}
+
+bool AssemblySource::open(const std::string& path) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    ::close(fd);
+    return false;
+  }
+  size = size_t(status.st_size);
+  if (size > 0) {
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      ::close(fd);
+      size = 0;
+      return false;
+    }
+    data = static_cast<const char*>(mapped);
+    madvise(mapped, size, MADV_SEQUENTIAL);
+  }
+  ::close(fd);
+
+  if (size > 0) {
+    lineStarts.push_back(0);
+  }
+  const char* position = data;
+  const char* end = data + size;
+  while (position < end) {
+    const char* newline = static_cast<const char*>(memchr(position, '\n', end - position));
+    if (!newline) {
+      break;
+    }
+    position = newline + 1;
+    if (position < end) {
+      lineStarts.push_back(position - data);
+    }
+  }
+  return true;
+}
+
+string_view AssemblySource::line(uint64_t lineNumber) const {
+  if (lineNumber == 0 || lineNumber > lineStarts.size()) {
+    return string_view();
+  }
+  size_t begin = lineStarts[lineNumber - 1];
+  size_t end = lineNumber < lineStarts.size() ? lineStarts[lineNumber] - 1 : size;
+  if (end > begin && end == size && data[end - 1] == '\n') {
+    end--;
+  }
+  return string_view(data + begin, end - begin);
+}
+
+vector<AssemblyInstruction> AssemblySource::lex(uint64_t startLine, uint64_t endLine) const {
+  vector<AssemblyInstruction> instructions;
+  for (uint64_t number = startLine; number <= endLine && number <= lineCount(); number++) {
+    instructions.push_back(lexInstruction(line(number), number));
+  }
+  return instructions;
+}
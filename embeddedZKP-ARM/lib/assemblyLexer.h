@@ -0,0 +1,97 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ASSEMBLY_LEXER_H
+#define ASSEMBLY_LEXER_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+using namespace std;
+
+// Register index of "sp", "xzr", "wzr" and of lines whose first operand is not a register
+const uint8_t noRegister = 31;
+
+enum class Opcode : uint8_t {
+  Add,    // add and addi
+  Mul,
+  Other   // anything the R1CS builder does not support
+};
+
+struct Operand {
+  enum class Kind : uint8_t { None, Register, Immediate, Unknown };
+  Kind kind = Kind::None;
+  uint8_t reg = 0;        // Register only
+  int64_t immediate = 0;  // Immediate only
+  string_view text;       // the token as written, e.g. "x1" or "#5"
+};
+
+// One line of the code block. Every string_view points into the mapped file,
+// so the IR stays valid as long as its AssemblySource is open.
+struct AssemblyInstruction {
+  uint64_t line;           // 1-based line number in the .s file
+  string_view text;        // the whole line
+  string_view mnemonic;
+  Opcode opcode = Opcode::Other;
+  uint8_t rd = noRegister;
+  Operand left;
+  Operand right;
+  uint32_t registersUsed = 0;  // bit i is set when xi/wi appears anywhere on the line
+};
+
+// Function to look up a register name; returns its index (sp, xzr and wzr are
+// 31, lr is 14, pc is 15) or -1. The first letter and the number select the
+// slot directly, so every name has its own slot and no string is compared.
+int registerIndex(string_view name);
+
+// Function to parse "#imm", "imm", "#0x.." or "#-imm"; false if the token is not an immediate
+bool parseImmediate(string_view token, int64_t& value);
+
+// Function to split one assembly line into a typed instruction
+AssemblyInstruction lexInstruction(string_view line, uint64_t lineNumber);
+
+// A memory-mapped .s file split into lines in a single pass
+class AssemblySource {
+public:
+  AssemblySource() = default;
+  ~AssemblySource();
+  AssemblySource(const AssemblySource&) = delete;
+  AssemblySource& operator=(const AssemblySource&) = delete;
+
+  // Function to map an assembly file and index its lines; a file mapped
+  // before is released first
+  bool open(const std::string& path);
+
+  // Function to unmap the file and forget its lines
+  void close();
+
+  // Number of lines, counting a last line without '\n'
+  uint64_t lineCount() const { return lineStarts.size(); }
+
+  // Function to get a line without its '\n' (1-based, like device_config.json)
+  string_view line(uint64_t lineNumber) const;
+
+  // Function to lex lines startLine..endLine into the instruction IR
+  vector<AssemblyInstruction> lex(uint64_t startLine, uint64_t endLine) const;
+
+private:
+  const char* data = nullptr;
+  size_t size = 0;
+  vector<size_t> lineStarts;
+};
+
+#endif  // ASSEMBLY_LEXER_H
@@ -0,0 +1,128 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "asyncProver.h"
+#include <iostream>
+
+AsyncProver::AsyncProver(size_t capacity, ProveFunction prove)
+  : capacity(capacity == 0 ? 1 : capacity), prove(std::move(prove)) {
+  proverThread = thread(&AsyncProver::worker, this);
+}
+
+AsyncProver::~AsyncProver() {
+  stop();
+}
+
+// Function to queue a witness snapshot without blocking the caller
+bool AsyncProver::submit(vector<uint64_t> witness) {
+  bool accepted = true;
+  {
+    lock_guard<mutex> guard(lock);
+    if (stopping) {
+      return false;
+    }
+    // Keep the freshest readings: a stale witness is worth less than a new one
+    if (queue.size() >= capacity) {
+      queue.pop_front();
+      droppedCount++;
+      accepted = false;
+    }
+    queue.emplace_back(++submittedCount, std::move(witness));
+  }
+  wakeUp.notify_one();
+  return accepted;
+}
+
+// Function to get the sequence number of the last submitted snapshot
+uint64_t AsyncProver::lastSubmitted() {
+  lock_guard<mutex> guard(lock);
+  return submittedCount;
+}
+
+// Function to register the callback invoked for every ready proof
+void AsyncProver::onProofReady(ReadyCallback callback) {
+  lock_guard<mutex> guard(lock);
+  ready = std::move(callback);
+}
+
+// Function to copy the most recent proof
+bool AsyncProver::latestProof(ordered_json& proof) {
+  lock_guard<mutex> guard(lock);
+  if (!hasLatest) {
+    return false;
+  }
+  proof = latest;
+  return true;
+}
+
+// Function to get the number of snapshots waiting for the worker
+size_t AsyncProver::pending() {
+  lock_guard<mutex> guard(lock);
+  return queue.size();
+}
+
+// Function to get the number of snapshots dropped because the queue was full
+uint64_t AsyncProver::dropped() {
+  lock_guard<mutex> guard(lock);
+  return droppedCount;
+}
+
+// Function to drain the queue and join the worker thread
+void AsyncProver::stop() {
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  if (proverThread.joinable()) {
+    proverThread.join();
+  }
+}
+
+void AsyncProver::worker() {
+  while (true) {
+    uint64_t sequence;
+    vector<uint64_t> witness;
+    {
+      unique_lock<mutex> guard(lock);
+      wakeUp.wait(guard, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      sequence = queue.front().first;
+      witness = std::move(queue.front().second);
+      queue.pop_front();
+    }
+
+    ordered_json proof;
+    try {
+      proof = prove(witness);
+    } catch (const std::exception& e) {
+      cerr << "Error: Fides proofGenerator failed: " << e.what() << endl;
+      continue;
+    }
+
+    ReadyCallback callback;
+    {
+      lock_guard<mutex> guard(lock);
+      latest = proof;
+      hasLatest = true;
+      callback = ready;
+    }
+    if (callback) {
+      callback(sequence, proof);
+    }
+  }
+}
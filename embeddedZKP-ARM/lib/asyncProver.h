@@ -0,0 +1,84 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ASYNC_PROVER_H
+#define ASYNC_PROVER_H
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "json.hpp"
+using ordered_json = nlohmann::ordered_json;
+
+using namespace std;
+
+// Background proving pipeline. The code block hands over a snapshot of z_array
+// and returns immediately; a single worker thread turns snapshots into proofs.
+class AsyncProver {
+public:
+  using ProveFunction = function<ordered_json(const vector<uint64_t>&)>;
+  using ReadyCallback = function<void(uint64_t sequence, const ordered_json&)>;
+
+  AsyncProver(size_t capacity, ProveFunction prove);
+  ~AsyncProver();
+
+  // Function to queue a witness snapshot without blocking the caller.
+  // When the queue is full the oldest snapshot is dropped and false is returned.
+  // Snapshots are numbered 1, 2, ... in submission order.
+  bool submit(vector<uint64_t> witness);
+
+  // Function to get the sequence number of the last submitted snapshot; 0 if none
+  uint64_t lastSubmitted();
+
+  // Function to register the callback invoked (on the worker thread) for every
+  // ready proof, with the sequence number of its snapshot. Proofs arrive in
+  // sequence order; a missing number was dropped or failed.
+  void onProofReady(ReadyCallback ready);
+
+  // Function to copy the most recent proof; returns false if none is ready yet
+  bool latestProof(ordered_json& proof);
+
+  // Function to get the number of snapshots waiting for the worker
+  size_t pending();
+
+  // Function to get the number of snapshots dropped because the queue was full
+  uint64_t dropped();
+
+  // Function to drain the queue and join the worker thread
+  void stop();
+
+private:
+  void worker();
+
+  size_t capacity;
+  ProveFunction prove;
+  ReadyCallback ready;
+
+  mutex lock;
+  condition_variable wakeUp;
+  deque<pair<uint64_t, vector<uint64_t>>> queue;
+  uint64_t submittedCount = 0;
+  ordered_json latest;
+  bool hasLatest = false;
+  bool stopping = false;
+  uint64_t droppedCount = 0;
+  thread proverThread;
+};
+
+#endif  // ASYNC_PROVER_H
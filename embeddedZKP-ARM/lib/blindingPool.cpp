@@ -0,0 +1,100 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "blindingPool.h"
+#include <iostream>
+#include <chrono>
+#include <pthread.h>
+#include <sched.h>
+
+BlindingPool::BlindingPool(size_t capacity, GenerateFunction generate)
+  : capacity(capacity == 0 ? 1 : capacity), generate(generate) {
+  refillThread = thread(&BlindingPool::worker, this);
+}
+
+BlindingPool::~BlindingPool() {
+  stop();
+}
+
+// Function to take one bundle for the given class; generates one inline if the pool is empty
+BlindingBundle BlindingPool::take(uint64_t Class) {
+  {
+    lock_guard<mutex> guard(lock);
+    // Bundles made for another class (after a new commitment) are useless
+    while (!pool.empty() && pool.front().Class != Class) {
+      pool.pop_front();
+    }
+    if (!pool.empty()) {
+      BlindingBundle bundle = std::move(pool.front());
+      pool.pop_front();
+      wakeUp.notify_one();
+      return bundle;
+    }
+    missCount++;
+  }
+  wakeUp.notify_one();
+  return generate();
+}
+
+// Function to get the number of ready bundles
+size_t BlindingPool::size() {
+  lock_guard<mutex> guard(lock);
+  return pool.size();
+}
+
+// Function to get the number of takes that found the pool empty
+uint64_t BlindingPool::misses() {
+  lock_guard<mutex> guard(lock);
+  return missCount;
+}
+
+// Function to stop the refill thread
+void BlindingPool::stop() {
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  if (refillThread.joinable()) {
+    refillThread.join();
+  }
+}
+
+void BlindingPool::worker() {
+  // Refilling is background work; let the sensor loop and the prover go first
+  struct sched_param param = {};
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+
+  while (true) {
+    {
+      unique_lock<mutex> guard(lock);
+      wakeUp.wait(guard, [this] { return stopping || pool.size() < capacity; });
+      if (stopping) {
+        return;
+      }
+    }
+
+    try {
+      BlindingBundle bundle = generate();
+      lock_guard<mutex> guard(lock);
+      pool.push_back(std::move(bundle));
+    } catch (const std::exception& e) {
+      // Usually the commitment or setup is not in place yet; try again later
+      cerr << "Error: Fides blinding pool refill failed: " << e.what() << endl;
+      unique_lock<mutex> guard(lock);
+      wakeUp.wait_for(guard, chrono::seconds(5), [this] { return stopping; });
+    }
+  }
+}
@@ -0,0 +1,78 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef BLINDING_POOL_H
+#define BLINDING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+using namespace std;
+
+// Witness-independent randomness of one proof. Every bundle is used exactly once.
+struct BlindingBundle {
+  uint64_t Class = 0;
+  int64_t b = 0;                  // number of extra interpolation points
+  vector<uint64_t> s_x;           // masking polynomial of degree 2n+b-1
+  uint64_t sigma1 = 0;            // sum of s_x over H
+  uint64_t Com_s_x = 0;           // KZG commitment of s_x
+  vector<uint64_t> extraPoints;   // b points outside H shared by z_hatA/B/C and w_hat
+  vector<uint64_t> zA_extra;      // b random values of z_hatA at extraPoints
+  vector<uint64_t> zB_extra;
+  vector<uint64_t> zC_extra;
+  vector<uint64_t> w_hat_extra;
+};
+
+// Bounded in-memory pool of blinding bundles, refilled by a background thread
+// running at idle priority so it only uses CPU time nothing else wants.
+class BlindingPool {
+public:
+  using GenerateFunction = function<BlindingBundle()>;
+
+  BlindingPool(size_t capacity, GenerateFunction generate);
+  ~BlindingPool();
+
+  // Function to take one bundle for the given class; generates one inline if the pool is empty
+  BlindingBundle take(uint64_t Class);
+
+  // Function to get the number of ready bundles
+  size_t size();
+
+  // Function to get the number of takes that found the pool empty
+  uint64_t misses();
+
+  // Function to stop the refill thread
+  void stop();
+
+private:
+  void worker();
+
+  size_t capacity;
+  GenerateFunction generate;
+
+  mutex lock;
+  condition_variable wakeUp;
+  deque<BlindingBundle> pool;
+  bool stopping = false;
+  uint64_t missCount = 0;
+  thread refillThread;
+};
+
+#endif  // BLINDING_POOL_H
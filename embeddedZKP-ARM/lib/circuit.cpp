@@ -0,0 +1,274 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "circuit.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <algorithm>
+
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p) {
+  return uint64_t((unsigned __int128)a * b % p);
+}
+
+// Immediates are field elements; negative ones wrap around p
+static uint64_t fieldValue(int64_t immediate, uint64_t p) {
+  if (immediate >= 0) {
+    return uint64_t(immediate);
+  }
+  uint64_t magnitude = uint64_t(-immediate) % p;
+  return magnitude == 0 ? 0 : p - magnitude;
+}
+
+// Function to drop terms with a zero coefficient
+static void dropZeroTerms(vector<CircuitTerm>& terms) {
+  terms.erase(remove_if(terms.begin(), terms.end(), [](const CircuitTerm& term) { return term.coefficient == 0; }), terms.end());
+}
+
+// Function to add up terms on the same column and drop zero coefficients
+static void normalize(vector<CircuitTerm>& terms, uint64_t p) {
+  vector<CircuitTerm> merged;
+  for (const auto& term : terms) {
+    bool found = false;
+    for (auto& existing : merged) {
+      if (existing.gate == term.gate && existing.index == term.index) {
+        existing.coefficient = (existing.coefficient + term.coefficient) % p;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      merged.push_back(term);
+    }
+  }
+  terms = merged;
+  dropZeroTerms(terms);
+}
+
+// Function to check whether a row only uses the constant column; c is its value
+static bool constantOf(const vector<CircuitTerm>& terms, uint64_t p, uint64_t& c) {
+  c = 0;
+  for (const auto& term : terms) {
+    if (term.gate || term.index != 0) {
+      return false;
+    }
+    c = (c + term.coefficient) % p;
+  }
+  return true;
+}
+
+static const CircuitTerm one = { false, 0, 1 };
+
+static bool isLinear(const CircuitGate& gate) {
+  return gate.a.size() == 1 && !gate.a[0].gate && gate.a[0].index == 0 && gate.a[0].coefficient == 1;
+}
+
+Circuit buildCircuit(const vector<AssemblyInstruction>& instructions, uint64_t n_i, uint64_t p) {
+  Circuit circuit;
+  circuit.n_i = n_i;
+  circuit.p = p;
+  circuit.recorded.assign(instructions.size(), true);
+
+  // Gate that last wrote each register; -1 while it still holds its zkp start value
+  vector<int64_t> latest(32, -1);
+  auto operandTerm = [&](const Operand& operand, const AssemblyInstruction& instruction) -> CircuitTerm {
+    if (operand.kind == Operand::Kind::Immediate) {
+      return { false, 0, fieldValue(operand.immediate, p) };
+    }
+    if (operand.kind != Operand::Kind::Register) {
+      throw std::runtime_error("Error: Fides commitmentGenerator cannot read the operand << " + std::string(operand.text) + " >> of line " + to_string(instruction.line) + " within the specified code_block range.\n");
+    }
+    if (latest[operand.reg] >= 0) {
+      return { true, uint64_t(latest[operand.reg]), 1 };
+    }
+    return { false, uint64_t(operand.reg) + 1, 1 };
+  };
+
+  for (size_t i = 0; i < instructions.size(); i++) {
+    const AssemblyInstruction& instruction = instructions[i];
+    if (instruction.opcode == Opcode::Other) {
+      throw std::runtime_error("Error: Fides commitmentGenerator program cannot recognize the opcode << " + std::string(instruction.mnemonic) + " >> within the specified code_block range. The code_block range is defined in the device_config.json file.\n");
+    }
+
+    CircuitGate gate;
+    gate.instruction = i;
+    gate.rd = instruction.rd;
+    if (instruction.opcode == Opcode::Add) {
+      // 1 * (left + right)
+      gate.a.push_back(one);
+      gate.b.push_back(operandTerm(instruction.left, instruction));
+      gate.b.push_back(operandTerm(instruction.right, instruction));
+    } else {
+      gate.a.push_back(operandTerm(instruction.left, instruction));
+      gate.b.push_back(operandTerm(instruction.right, instruction));
+    }
+    // Operands on the same column are only added up by the optimizer; without
+    // it the R1CS builder writes them to one entry, as it always has
+    dropZeroTerms(gate.b);
+    latest[instruction.rd] = int64_t(circuit.gates.size());
+    circuit.gates.push_back(gate);
+  }
+  return circuit;
+}
+
+OptimizerReport optimizeCircuit(Circuit& circuit) {
+  vector<CircuitGate>& gates = circuit.gates;
+  const uint64_t p = circuit.p;
+  const size_t count = gates.size();
+
+  OptimizerReport report;
+  report.gatesBefore = count;
+
+  // The last value written to each register is visible after the block
+  vector<bool> output(count, false);
+  vector<int64_t> lastWriter(32, -1);
+  for (size_t g = 0; g < count; g++) {
+    if (gates[g].rd != noRegister) {
+      lastWriter[gates[g].rd] = int64_t(g);
+    }
+  }
+  for (int64_t writer : lastWriter) {
+    if (writer >= 0) {
+      output[writer] = true;
+    }
+  }
+
+  // Constant folding. A product with one constant side becomes linear, which
+  // lets a mul by an immediate merge with the add that follows it.
+  vector<bool> isConstant(count, false);
+  vector<uint64_t> value(count, 0);
+  auto substitute = [&](vector<CircuitTerm>& terms) {
+    for (auto& term : terms) {
+      if (term.gate && isConstant[term.index]) {
+        term = { false, 0, mulMod(term.coefficient, value[term.index], p) };
+      }
+    }
+    normalize(terms, p);
+  };
+  for (size_t g = 0; g < count; g++) {
+    CircuitGate& gate = gates[g];
+    substitute(gate.a);
+    substitute(gate.b);
+    uint64_t ca, cb;
+    bool constantA = constantOf(gate.a, p, ca);
+    bool constantB = constantOf(gate.b, p, cb);
+    if (constantA && constantB) {
+      isConstant[g] = true;
+      value[g] = mulMod(ca, cb, p);
+      // A constant the block leaves in a register is still proven
+      gate.a = { one };
+      gate.b.clear();
+      if (value[g] != 0) {
+        gate.b.push_back({ false, 0, value[g] });
+      }
+    } else if (constantA) {
+      for (auto& term : gate.b) {
+        term.coefficient = mulMod(term.coefficient, ca, p);
+      }
+      gate.a = { one };
+    } else if (constantB) {
+      gate.b = gate.a;
+      for (auto& term : gate.b) {
+        term.coefficient = mulMod(term.coefficient, cb, p);
+      }
+      gate.a = { one };
+    }
+  }
+
+  // Dead results: walk backwards so a gate only read by dead gates dies too
+  vector<size_t> uses(count, 0);
+  for (size_t g = 0; g < count; g++) {
+    for (const auto* row : { &gates[g].a, &gates[g].b }) {
+      for (const auto& term : *row) {
+        if (term.gate) {
+          uses[term.index]++;
+        }
+      }
+    }
+  }
+  vector<bool> live(count, false);
+  for (size_t g = count; g-- > 0;) {
+    if (isConstant[g] && !output[g]) {
+      report.folded++;
+      continue;
+    }
+    live[g] = output[g] || uses[g] > 0;
+    if (!live[g]) {
+      report.dead++;
+      for (const auto* row : { &gates[g].a, &gates[g].b }) {
+        for (const auto& term : *row) {
+          if (term.gate) {
+            uses[term.index]--;
+          }
+        }
+      }
+    }
+  }
+
+  // Merge a linear gate read exactly once into the B row of its reader. A
+  // must stay a single column, so a product only takes it on its B side.
+  vector<bool> merged(count, false);
+  auto inlinable = [&](const CircuitTerm& term) {
+    return term.gate && live[term.index] && !output[term.index] && uses[term.index] == 1 && isLinear(gates[term.index]);
+  };
+  for (size_t g = 0; g < count; g++) {
+    if (!live[g]) {
+      continue;
+    }
+    CircuitGate& gate = gates[g];
+    if (!isLinear(gate) && gate.a.size() == 1 && inlinable(gate.a[0]) &&
+        gate.b.size() == 1 && gate.b[0].coefficient == 1 && !inlinable(gate.b[0])) {
+      swap(gate.a, gate.b);
+    }
+    vector<CircuitTerm> expanded;
+    for (const auto& term : gate.b) {
+      if (!inlinable(term)) {
+        expanded.push_back(term);
+        continue;
+      }
+      for (const auto& inner : gates[term.index].b) {
+        expanded.push_back({ inner.gate, inner.index, mulMod(inner.coefficient, term.coefficient, p) });
+      }
+      merged[term.index] = true;
+      report.merged++;
+    }
+    normalize(expanded, p);
+    gate.b = expanded;
+  }
+
+  // Renumber the gates that are left
+  vector<int64_t> renumber(count, -1);
+  vector<CircuitGate> kept;
+  for (size_t g = 0; g < count; g++) {
+    if (live[g] && !merged[g]) {
+      renumber[g] = int64_t(kept.size());
+      kept.push_back(gates[g]);
+    }
+  }
+  circuit.recorded.assign(circuit.recorded.size(), false);
+  for (auto& gate : kept) {
+    for (auto* row : { &gate.a, &gate.b }) {
+      for (auto& term : *row) {
+        if (term.gate) {
+          term.index = uint64_t(renumber[term.index]);
+        }
+      }
+    }
+    circuit.recorded[gate.instruction] = true;
+  }
+  gates = kept;
+  report.gatesAfter = gates.size();
+  return report;
+}
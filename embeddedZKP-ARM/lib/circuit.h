@@ -0,0 +1,74 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CIRCUIT_H
+#define CIRCUIT_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "assemblyLexer.h"
+
+using namespace std;
+
+// One entry of an A or B row: coefficient * z[column], where the column is
+// either fixed (0 is the constant 1, i + 1 is xi at zkp start) or the output
+// of an earlier gate
+struct CircuitTerm {
+  bool gate;
+  uint64_t index;         // gate number if gate, z column otherwise
+  uint64_t coefficient;   // in F_p
+};
+
+// One R1CS row: (A z) * (B z) = z[row]. The prover rebuilds A from a single
+// column with value 1 per row and C as the identity, so a stays one term with
+// coefficient 1 and every linear combination lives in b.
+struct CircuitGate {
+  size_t instruction;         // index in the code block of the instruction whose Rd holds the value
+  uint8_t rd;
+  vector<CircuitTerm> a;
+  vector<CircuitTerm> b;
+};
+
+struct Circuit {
+  uint64_t n_i = 0;
+  uint64_t p = 0;
+  vector<CircuitGate> gates;
+  vector<bool> recorded;      // per instruction: its Rd is stored into z_array
+
+  // Function to get the z column a term refers to
+  uint64_t column(const CircuitTerm& term) const {
+    return term.gate ? 1 + n_i + term.index : term.index;
+  }
+};
+
+struct OptimizerReport {
+  size_t gatesBefore = 0;
+  size_t gatesAfter = 0;
+  size_t folded = 0;    // gates whose value is a constant
+  size_t merged = 0;    // linear gates substituted into their only consumer
+  size_t dead = 0;      // gates whose value is overwritten before it is used
+};
+
+// Function to map every instruction of the code block onto one gate, the way
+// the R1CS has always been built
+Circuit buildCircuit(const vector<AssemblyInstruction>& instructions, uint64_t n_i, uint64_t p);
+
+// Function to fold constants, merge single-use linear gates into their consumer
+// and drop dead gates. A gate stays if its value is read by a later gate or is
+// the last value written to its register in the block.
+OptimizerReport optimizeCircuit(Circuit& circuit);
+
+#endif  // CIRCUIT_H
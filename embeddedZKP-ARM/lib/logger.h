@@ -0,0 +1,152 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+
+// Log levels, from quiet to verbose. Two limits apply:
+// - FIDES_LOG_LEVEL at compile time (-DFIDES_LOG_LEVEL=3): statements above it
+//   are removed from the binary.
+// - FIDES_LOG_LEVEL in the environment ("error", "info", "trace" or 0..5) at
+//   run time, Info by default. A disabled statement does not evaluate its
+//   message.
+enum class LogLevel : int { Off = 0, Error = 1, Warning = 2, Info = 3, Debug = 4, Trace = 5 };
+
+#ifndef FIDES_LOG_LEVEL
+#define FIDES_LOG_LEVEL 5
+#endif
+
+// Function to parse a level name or number; fallback if it is neither
+inline LogLevel parseLogLevel(const char* text, LogLevel fallback) {
+  if (!text || !*text) {
+    return fallback;
+  }
+  const char* names[] = { "off", "error", "warning", "info", "debug", "trace" };
+  for (int level = 0; level <= 5; level++) {
+    if (strcmp(text, names[level]) == 0 || (text[0] == '0' + level && text[1] == '\0')) {
+      return LogLevel(level);
+    }
+  }
+  return fallback;
+}
+
+inline LogLevel& runtimeLogLevel() {
+  static LogLevel level = parseLogLevel(getenv("FIDES_LOG_LEVEL"), LogLevel::Info);
+  return level;
+}
+
+inline void setLogLevel(LogLevel level) {
+  runtimeLogLevel() = level;
+}
+
+inline bool logEnabled(LogLevel level) {
+  return int(level) <= FIDES_LOG_LEVEL && level <= runtimeLogLevel();
+}
+
+#define FIDES_LOG(level, message)                 \
+  do {                                            \
+    if (logEnabled(level)) {                      \
+      std::cout << message << std::endl;          \
+    }                                             \
+  } while (0)
+
+// Binary dump of intermediate values, written instead of printing them when
+// FIDES_DEBUG_DUMP names a file. Each record is
+//   uint32_t nameLength, char name[nameLength], uint64_t rows, uint64_t columns,
+//   uint64_t values[rows * columns]
+// in host byte order; a polynomial is one row of coefficients. A matrix whose
+// rows differ in length is refused with a warning. Records are
+// flushed as they are written, so a dump survives a crash. src/dumpReader
+// lists a dump.
+class DebugDump {
+public:
+  static DebugDump& instance() {
+    static DebugDump dump(getenv("FIDES_DEBUG_DUMP"));
+    return dump;
+  }
+
+  bool enabled() const { return file != nullptr; }
+
+  void write(const string& name, const vector<uint64_t>& values) {
+    if (!file) {
+      return;
+    }
+    lock_guard<mutex> guard(lock);
+    header(name, 1, values.size());
+    fwrite(values.data(), sizeof(uint64_t), values.size(), file);
+    fflush(file);
+  }
+
+  void write(const string& name, const vector<vector<uint64_t>>& rows) {
+    if (!file) {
+      return;
+    }
+    uint64_t columns = rows.empty() ? 0 : rows[0].size();
+    for (const auto& row : rows) {
+      if (row.size() != columns) {
+        // A record is rectangular; guessing a width would lose or invent values
+        cerr << "Warning: " << name << " has rows of different lengths and is not written to the debug dump" << endl;
+        return;
+      }
+    }
+    lock_guard<mutex> guard(lock);
+    header(name, rows.size(), columns);
+    for (const auto& row : rows) {
+      fwrite(row.data(), sizeof(uint64_t), columns, file);
+    }
+    fflush(file);
+  }
+
+  ~DebugDump() {
+    if (file) {
+      fclose(file);
+    }
+  }
+
+private:
+  explicit DebugDump(const char* path) {
+    if (path && *path) {
+      file = fopen(path, "wb");
+      if (!file) {
+        cerr << "Warning: cannot open the debug dump " << path << endl;
+      }
+    }
+  }
+
+  void header(const string& name, uint64_t rows, uint64_t columns) {
+    uint32_t length = uint32_t(name.size());
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(name.data(), 1, length, file);
+    fwrite(&rows, sizeof(rows), 1, file);
+    fwrite(&columns, sizeof(columns), 1, file);
+  }
+
+  FILE* file = nullptr;
+  mutex lock;
+};
+
+#endif  // LOGGER_H
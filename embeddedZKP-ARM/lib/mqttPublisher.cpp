@@ -0,0 +1,180 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mqttPublisher.h"
+#include <iostream>
+#include <vector>
+
+MqttPublisher::MqttPublisher(struct mosquitto* mosq, size_t capacity, size_t batchSize, int qos, bool retain)
+  : mosq(mosq), capacity(capacity == 0 ? 1 : capacity), batchSize(batchSize == 0 ? 1 : batchSize), qos(qos), retain(retain) {
+}
+
+MqttPublisher::~MqttPublisher() {
+  stop();
+}
+
+// Function to start the network loop and the publisher thread once
+bool MqttPublisher::start() {
+  lock_guard<mutex> guard(lock);
+  if (running) {
+    return true;
+  }
+  int rc = mosquitto_loop_start(mosq);
+  if (rc != MOSQ_ERR_SUCCESS) {
+    cerr << "❌ Failed to start the MQTT network loop: " << mosquitto_strerror(rc) << endl;
+    return false;
+  }
+  running = true;
+  stopping = false;
+  publisherThread = thread(&MqttPublisher::worker, this);
+  return true;
+}
+
+// Function to stop the publisher thread and the network loop
+void MqttPublisher::stop() {
+  {
+    lock_guard<mutex> guard(lock);
+    if (!running) {
+      return;
+    }
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  if (publisherThread.joinable()) {
+    publisherThread.join();
+  }
+  mosquitto_disconnect(mosq);
+  mosquitto_loop_stop(mosq, false);
+  lock_guard<mutex> guard(lock);
+  running = false;
+}
+
+// Function to queue a message; returns false when the queue is full
+bool MqttPublisher::publish(const std::string& topic, std::string payload) {
+  {
+    lock_guard<mutex> guard(lock);
+    if (queue.size() >= capacity) {
+      counters.rejected++;
+      return false;
+    }
+    queue.push_back({topic, std::move(payload), Clock::now()});
+    counters.queued++;
+    if (queue.size() > counters.maxQueueDepth) {
+      counters.maxQueueDepth = queue.size();
+    }
+  }
+  wakeUp.notify_one();
+  return true;
+}
+
+// Function to wait up to timeoutMs until every queued message has been published
+bool MqttPublisher::flush(int timeoutMs) {
+  unique_lock<mutex> guard(lock);
+  return drained.wait_for(guard, chrono::milliseconds(timeoutMs), [this] {
+    return queue.empty() && inFlight.empty();
+  });
+}
+
+// Function to be called from the mosquitto connect/disconnect callbacks
+void MqttPublisher::connected(bool connectedNow) {
+  {
+    lock_guard<mutex> guard(lock);
+    isConnected = connectedNow;
+    if (!connectedNow && qos == 0) {
+      counters.lost += inFlight.size();
+      inFlight.clear();
+      earlyAcks.clear();
+    }
+  }
+  wakeUp.notify_all();
+  drained.notify_all();
+}
+
+// Function to be called from the mosquitto publish callback
+void MqttPublisher::published(int mid) {
+  Clock::time_point now = Clock::now();
+  {
+    lock_guard<mutex> guard(lock);
+    auto entry = inFlight.find(mid);
+    if (entry == inFlight.end()) {
+      earlyAcks[mid] = now;
+      return;
+    }
+    recordLatency(entry->second, now);
+    inFlight.erase(entry);
+  }
+  drained.notify_all();
+}
+
+// Function to take a snapshot of the queue and latency counters
+MqttPublisher::Metrics MqttPublisher::metrics() {
+  lock_guard<mutex> guard(lock);
+  Metrics snapshot = counters;
+  snapshot.queueDepth = queue.size();
+  snapshot.averageLatencyMs = counters.published ? totalLatencyMs / counters.published : 0;
+  return snapshot;
+}
+
+// Caller holds the lock
+void MqttPublisher::recordLatency(Clock::time_point queuedAt, Clock::time_point doneAt) {
+  double latencyMs = chrono::duration<double, milli>(doneAt - queuedAt).count();
+  counters.published++;
+  totalLatencyMs += latencyMs;
+  if (latencyMs > counters.maxLatencyMs) {
+    counters.maxLatencyMs = latencyMs;
+  }
+}
+
+void MqttPublisher::worker() {
+  while (true) {
+    vector<Message> batch;
+    {
+      unique_lock<mutex> guard(lock);
+      wakeUp.wait(guard, [this] { return stopping || (isConnected && !queue.empty()); });
+      if (!isConnected || queue.empty()) {
+        return;  // stopping; whatever is still queued cannot be delivered
+      }
+      while (!queue.empty() && batch.size() < batchSize) {
+        batch.push_back(std::move(queue.front()));
+        queue.pop_front();
+      }
+    }
+
+    for (size_t i = 0; i < batch.size(); i++) {
+      int mid = 0;
+      int rc = mosquitto_publish(mosq, &mid, batch[i].topic.c_str(), batch[i].payload.size(), batch[i].payload.data(), qos, retain);
+
+      lock_guard<mutex> guard(lock);
+      if (rc == MOSQ_ERR_SUCCESS) {
+        auto ack = earlyAcks.find(mid);
+        if (ack != earlyAcks.end()) {
+          recordLatency(batch[i].queuedAt, ack->second);
+          earlyAcks.erase(ack);
+        } else {
+          inFlight[mid] = batch[i].queuedAt;
+        }
+      } else if (rc == MOSQ_ERR_NO_CONN) {
+        // Keep the rest of the batch, in order, until the broker is back
+        isConnected = false;
+        queue.insert(queue.begin(), make_move_iterator(batch.begin() + i), make_move_iterator(batch.end()));
+        break;
+      } else {
+        counters.failed++;
+        cerr << "❌ Publish failed: " << mosquitto_strerror(rc) << endl;
+      }
+    }
+    drained.notify_all();
+  }
+}
@@ -0,0 +1,107 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <mosquitto.h>
+
+using namespace std;
+
+// Bounded publish queue in front of one persistent mosquitto network thread.
+// Producers never touch the socket; a publisher thread drains the queue in
+// batches and holds messages back while the broker is unreachable.
+class MqttPublisher {
+public:
+  struct Metrics {
+    uint64_t queued = 0;          // accepted by publish()
+    uint64_t published = 0;       // handed to the broker by the network thread
+    uint64_t rejected = 0;        // refused because the queue was full
+    uint64_t failed = 0;          // refused by mosquitto_publish
+    uint64_t lost = 0;            // QoS 0 messages still unacknowledged at a disconnect
+    size_t queueDepth = 0;
+    size_t maxQueueDepth = 0;
+    double averageLatencyMs = 0;  // publish() call to on_publish callback
+    double maxLatencyMs = 0;
+  };
+
+  MqttPublisher(struct mosquitto* mosq, size_t capacity = 64, size_t batchSize = 8, int qos = 0, bool retain = false);
+  ~MqttPublisher();
+
+  // Function to start the network loop and the publisher thread once
+  bool start();
+
+  // Function to stop the publisher thread and the network loop
+  void stop();
+
+  // Function to queue a message; returns false when the queue is full
+  bool publish(const std::string& topic, std::string payload);
+
+  // Function to wait up to timeoutMs until every queued message has been
+  // published; false on timeout
+  bool flush(int timeoutMs);
+
+  // Function to be called from the mosquitto connect/disconnect callbacks.
+  // A disconnect forgets the QoS 0 messages in flight, which will never be
+  // acknowledged; QoS 1 and 2 ones are resent by mosquitto on reconnect.
+  void connected(bool connectedNow);
+
+  // Function to be called from the mosquitto publish callback
+  void published(int mid);
+
+  // Function to take a snapshot of the queue and latency counters
+  Metrics metrics();
+
+private:
+  using Clock = chrono::steady_clock;
+
+  struct Message {
+    std::string topic;
+    std::string payload;
+    Clock::time_point queuedAt;
+  };
+
+  void worker();
+  void recordLatency(Clock::time_point queuedAt, Clock::time_point doneAt);
+
+  struct mosquitto* mosq;
+  size_t capacity;
+  size_t batchSize;
+  int qos;
+  bool retain;
+
+  mutex lock;
+  condition_variable wakeUp;
+  condition_variable drained;
+  deque<Message> queue;
+  unordered_map<int, Clock::time_point> inFlight;
+  unordered_map<int, Clock::time_point> earlyAcks;  // acks that beat the mid bookkeeping
+  bool isConnected = false;
+  bool running = false;
+  bool stopping = false;
+  Metrics counters;
+  double totalLatencyMs = 0;
+  thread publisherThread;
+};
+
+#endif  // MQTT_PUBLISHER_H
@@ -341,12 +341,11 @@ vector<uint64_t> Polynomial::setupNewtonPolynomial(const vector<uint64_t>& x_val
 
 // Function to parse the polynomial string and evaluate it
 uint64_t Polynomial::evaluatePolynomial(const vector<uint64_t>& polynomial, uint64_t x, uint64_t p) {
+  // Horner's rule from the highest coefficient: one multiplication per term
   uint64_t result = 0;
-  uint64_t power_of_x = 1; // x^0 initially
-
-  for (size_t i = 0; i < polynomial.size(); i++) {
-    result = (result + polynomial[i] * power_of_x) % p;
-    power_of_x = (power_of_x * x) % p;
+  x %= p;
+  for (size_t i = polynomial.size(); i-- > 0;) {
+    result = (result * x + polynomial[i]) % p;
   }
 
   return result;
@@ -416,35 +415,27 @@ vector<uint64_t> Polynomial::expandPolynomials(const vector<uint64_t>& roots, ui
 }
 
 // Function to print polynomial in serial
-void Polynomial::printPolynomial(const vector<uint64_t>& coefficients, const std::string& name) {
-  // Iterate through the coefficients and print each term of the polynomial
-  vector<int64_t> coefficientsBuf;
-  for (size_t i = 0; i < coefficients.size(); i++)
-  {
-    coefficientsBuf.push_back(coefficients[i]);
+void Polynomial::writePolynomial(const vector<uint64_t>& coefficients, const std::string& name) {
+  DebugDump::instance().write(name, coefficients);
+  if (!logEnabled(LogLevel::Debug)) {
+    return;
   }
-  
+
+  // Iterate through the coefficients and print each term of the polynomial
   cout << name  << " = ";
   bool first = true;
-  for (int64_t i = coefficientsBuf.size() - 1; i >= 0; i--) {
-    if (coefficientsBuf[i] == 0) continue;  // Skip zero coefficients
+  for (size_t i = coefficients.size(); i-- > 0;) {
+    if (coefficients[i] == 0) continue;  // Skip zero coefficients
 
     // Print the sign for all terms except the first
     if (!first) {
-      if (coefficientsBuf[i] > 0) {
-        cout << " + ";
-      } else {
-        cout << " - ";
-      }
+      cout << " + ";
     } else {
       first = false;
     }
 
-    // Print the absolute value of the coefficient
-    cout << abs(coefficientsBuf[i]);
-
-    // Print the variable and the exponent
-    cout << "x^" << i;
+    // Print the coefficient, the variable and the exponent
+    cout << coefficients[i] << "x^" << i;
   }
   cout << endl;
 }
@@ -467,7 +458,11 @@ std::string Polynomial::removeCommas(const std::string& str) {
     return str.substr(first, last - first + 1);
 }
 
-void Polynomial::printMatrix(vector<vector<uint64_t>>& matrix, const std::string& name) {
+void Polynomial::writeMatrix(const vector<vector<uint64_t>>& matrix, const std::string& name) {
+  DebugDump::instance().write(name, matrix);
+  if (!logEnabled(LogLevel::Trace)) {
+    return;
+  }
   cout << "Matrix " << name << ":" << endl;
   for (const auto& row : matrix) {
     for (uint64_t val : row) {
@@ -523,7 +518,11 @@ vector<vector<uint64_t>> Polynomial::createMapping(const vector<uint64_t>& K, co
 }
 
 // Function to print the mapping
-void Polynomial::printMapping(vector<vector<uint64_t>>& row, const std::string& name) {
+void Polynomial::writeMapping(const vector<vector<uint64_t>>& row, const std::string& name) {
+  DebugDump::instance().write(name, row);
+  if (!logEnabled(LogLevel::Trace)) {
+    return;
+  }
   for (uint64_t i = 0; i < row[0].size(); i++) {
     cout << name << "(" << row[0][i] << ") = " << row[1][i] << endl;
   }
@@ -580,6 +579,10 @@ uint64_t Polynomial::e_func(uint64_t a, uint64_t b, uint64_t g, uint64_t p) {
 
   // Function to calculate KZG in p
 uint64_t Polynomial::KZG_Commitment(vector<uint64_t> a, vector<uint64_t> b, uint64_t p) {
+  return KZG_Commitment(a.data(), b, p);
+}
+
+uint64_t Polynomial::KZG_Commitment(const uint64_t* a, const vector<uint64_t>& b, uint64_t p) {
   uint64_t res = 0;
   for (uint64_t i = 0; i < b.size(); i++) {
     res += (a[i] * b[i]) % p;
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <algorithm>
 #include <string>
+#include "logger.h"
 
 using namespace std;
 
@@ -82,8 +83,14 @@ public:
   // Function to expand polynomials given the roots
   static vector<uint64_t> expandPolynomials(const vector<uint64_t>& roots, uint64_t p);
 
-  // Function to print polynomial in serial
-  static void printPolynomial(const vector<uint64_t>& coefficients, const std::string& name);
+  // Function to print polynomial in serial at the Debug level, and to record it
+  // in the debug dump; nothing is done when neither is enabled
+  static void printPolynomial(const vector<uint64_t>& coefficients, const std::string& name) {
+    if (logEnabled(LogLevel::Debug) || DebugDump::instance().enabled()) {
+      writePolynomial(coefficients, name);
+    }
+  }
+  static void writePolynomial(const vector<uint64_t>& coefficients, const std::string& name);
 
   // Utility functions for trimming
   static std::string trim(const std::string& str);
@@ -91,8 +98,13 @@ public:
   // Utility functions for removing commas
   static std::string removeCommas(const std::string& str);
 
-  // Utility functions to print a Matrix
-  static void printMatrix(vector<vector<uint64_t>>& matrix, const std::string& name);
+  // Utility functions to print a Matrix at the Trace level, and to record it in the debug dump
+  static void printMatrix(const vector<vector<uint64_t>>& matrix, const std::string& name) {
+    if (logEnabled(LogLevel::Trace) || DebugDump::instance().enabled()) {
+      writeMatrix(matrix, name);
+    }
+  }
+  static void writeMatrix(const vector<vector<uint64_t>>& matrix, const std::string& name);
 
   // Function to get the row indices of non-zero entries in matrix
   static vector<vector<uint64_t>> getNonZeroRows(const vector<vector<uint64_t>>& matrix);
@@ -103,8 +115,13 @@ public:
   // Function to create the mapping
   static vector<vector<uint64_t>> createMapping(const vector<uint64_t>& K, const vector<uint64_t>& H, const vector<vector<uint64_t>>& nonZero);
 
-  // Function to print the mapping
-  static void printMapping(vector<vector<uint64_t> >& row, const std::string& name);
+  // Function to print the mapping at the Trace level, and to record it in the debug dump
+  static void printMapping(const vector<vector<uint64_t> >& row, const std::string& name) {
+    if (logEnabled(LogLevel::Trace) || DebugDump::instance().enabled()) {
+      writeMapping(row, name);
+    }
+  }
+  static void writeMapping(const vector<vector<uint64_t> >& row, const std::string& name);
 
   // Function to create the val mapping
   static vector<vector<uint64_t>> valMapping(const vector<uint64_t>& K, const vector<uint64_t>& H, vector<vector<uint64_t>>& nonZeroRows, vector<vector<uint64_t>>& nonZeroCols, uint64_t p);
@@ -118,6 +135,9 @@ public:
   // Function to calculate KZG in p
   static uint64_t KZG_Commitment(vector<uint64_t> a, vector<uint64_t> b, uint64_t p);
 
+  // Function to calculate KZG in p with ck read in place, e.g. from the mapped srs.bin
+  static uint64_t KZG_Commitment(const uint64_t* a, const vector<uint64_t>& b, uint64_t p);
+
   // Function to compute the SHA-256 hash of an uint64_t and return the lower 4 bytes as uint64_t, applying a modulo operation
   static uint64_t hashAndExtractLower4Bytes(uint64_t inputNumber, uint64_t p);
 
@@ -0,0 +1,248 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "proofEnvelope.h"
+#include <stdexcept>
+
+namespace {
+
+// Blob layout: "FZP" + version, commitmentId, class, then every field below in
+// order. The commitmentId is a varint of twice its length plus a flag, then the
+// raw bytes of a lowercase hex digest (flag 0) or, for any other id, its
+// characters as they are (flag 1), so every id comes back unchanged. Numbers are LEB128 varints
+// since all values are reduced mod p and stay far below 64 bits. Any other
+// field of the proof follows as a count and, per field, its name and its
+// value in CBOR, so a field added to the proof is never lost on the way.
+const uint8_t blobMagic[4] = {'F', 'Z', 'P', 2};
+
+struct ProofField {
+  const char* name;
+  bool isPolynomial;
+};
+
+const ProofField proofFields[] = {
+  {"P_AHP1", false},  {"P_AHP2", true},   {"P_AHP3", true},   {"P_AHP4", true},
+  {"P_AHP5", true},   {"P_AHP6", true},   {"P_AHP7", true},   {"P_AHP8", true},
+  {"P_AHP9", true},   {"P_AHP10", false}, {"P_AHP11", true},  {"P_AHP12", true},
+  {"P_AHP13", false}, {"P_AHP14", true},  {"P_AHP15", true},  {"P_AHP16", false},
+  {"P_AHP17", false},
+  {"Com_AHP1_x", true},   {"Com_AHP2_x", false},  {"Com_AHP3_x", false},  {"Com_AHP4_x", false},
+  {"Com_AHP5_x", false},  {"Com_AHP6_x", false},  {"Com_AHP7_x", false},  {"Com_AHP8_x", false},
+  {"Com_AHP9_x", false},  {"Com_AHP10_x", false}, {"Com_AHP11_x", false}, {"Com_AHP12_x", false},
+  {"Com_AHP13_x", false}
+};
+
+void putVarint(vector<uint8_t>& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(uint8_t(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(uint8_t(value));
+}
+
+void putBytes(vector<uint8_t>& out, const vector<uint8_t>& bytes) {
+  putVarint(out, bytes.size());
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+uint64_t getVarint(const vector<uint8_t>& in, size_t& pos) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (pos >= in.size()) {
+      throw std::runtime_error("Error: Fides proof envelope is truncated");
+    }
+    uint8_t byte = in[pos++];
+    value |= uint64_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  throw std::runtime_error("Error: Fides proof envelope has an invalid number");
+}
+
+vector<uint8_t> getBytes(const vector<uint8_t>& in, size_t& pos) {
+  uint64_t length = getVarint(in, pos);
+  if (length > in.size() - pos) {
+    throw std::runtime_error("Error: Fides proof envelope is truncated");
+  }
+  vector<uint8_t> bytes(in.begin() + pos, in.begin() + pos + length);
+  pos += length;
+  return bytes;
+}
+
+bool isPackedField(const std::string& name) {
+  if (name == "commitmentId" || name == "class") {
+    return true;
+  }
+  for (const ProofField& field : proofFields) {
+    if (name == field.name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// Function to check that an id is a lowercase hex digest the blob can store as bytes
+bool isPackableId(const std::string& id) {
+  if (id.size() % 2 != 0) {
+    return false;
+  }
+  for (char c : id) {
+    if (hexValue(c) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// Function to parse "json", "cbor" or "msgpack"
+PayloadFormat parsePayloadFormat(const std::string& name) {
+  if (name == "json") return PayloadFormat::Json;
+  if (name == "cbor") return PayloadFormat::Cbor;
+  if (name == "msgpack") return PayloadFormat::MsgPack;
+  throw std::runtime_error("Error: Fides unknown payload format '" + name + "'");
+}
+
+// Function to pack a proof (as written to data/proof.json) into a compact blob
+vector<uint8_t> packProof(const ordered_json& proof) {
+  vector<uint8_t> blob(blobMagic, blobMagic + 4);
+
+  std::string commitmentId = proof.at("commitmentId").get<std::string>();
+  if (isPackableId(commitmentId)) {
+    putVarint(blob, (commitmentId.size() / 2) << 1);
+    for (size_t i = 0; i < commitmentId.size(); i += 2) {
+      blob.push_back(uint8_t(hexValue(commitmentId[i]) << 4 | hexValue(commitmentId[i + 1])));
+    }
+  } else {
+    putVarint(blob, uint64_t(commitmentId.size()) << 1 | 1);
+    blob.insert(blob.end(), commitmentId.begin(), commitmentId.end());
+  }
+  putVarint(blob, proof.at("class").get<uint64_t>());
+
+  for (const ProofField& field : proofFields) {
+    const ordered_json& value = proof.at(field.name);
+    if (field.isPolynomial) {
+      putVarint(blob, value.size());
+      for (const auto& coefficient : value) {
+        putVarint(blob, coefficient.get<uint64_t>());
+      }
+    } else {
+      putVarint(blob, value.get<uint64_t>());
+    }
+  }
+
+  vector<string> extraFields;
+  for (const auto& item : proof.items()) {
+    if (!isPackedField(item.key())) {
+      extraFields.push_back(item.key());
+    }
+  }
+  putVarint(blob, extraFields.size());
+  for (const string& name : extraFields) {
+    putBytes(blob, vector<uint8_t>(name.begin(), name.end()));
+    putBytes(blob, ordered_json::to_cbor(proof[name]));
+  }
+  return blob;
+}
+
+// Function to unpack a blob produced by packProof
+ordered_json unpackProof(const vector<uint8_t>& blob) {
+  if (blob.size() < 4 || !std::equal(blobMagic, blobMagic + 4, blob.begin())) {
+    throw std::runtime_error("Error: Fides proof envelope has an unknown header");
+  }
+  size_t pos = 4;
+  static const char digits[] = "0123456789abcdef";
+
+  ordered_json proof;
+  uint64_t idHeader = getVarint(blob, pos);
+  uint64_t idBytes = idHeader >> 1;
+  if (idBytes > blob.size() - pos) {
+    throw std::runtime_error("Error: Fides proof envelope is truncated");
+  }
+  std::string commitmentId;
+  if (idHeader & 1) {
+    commitmentId.assign(blob.begin() + pos, blob.begin() + pos + idBytes);
+    pos += idBytes;
+  } else {
+    for (uint64_t i = 0; i < idBytes; i++) {
+      commitmentId += digits[blob[pos] >> 4];
+      commitmentId += digits[blob[pos] & 0xf];
+      pos++;
+    }
+  }
+  proof["commitmentId"] = commitmentId;
+  proof["class"] = getVarint(blob, pos);
+
+  for (const ProofField& field : proofFields) {
+    if (field.isPolynomial) {
+      uint64_t length = getVarint(blob, pos);
+      if (length > blob.size() - pos) {
+        throw std::runtime_error("Error: Fides proof envelope is truncated");
+      }
+      vector<uint64_t> coefficients(length);
+      for (uint64_t& coefficient : coefficients) {
+        coefficient = getVarint(blob, pos);
+      }
+      proof[field.name] = coefficients;
+    } else {
+      proof[field.name] = getVarint(blob, pos);
+    }
+  }
+
+  uint64_t extraFields = getVarint(blob, pos);
+  for (uint64_t i = 0; i < extraFields; i++) {
+    vector<uint8_t> name = getBytes(blob, pos);
+    proof[string(name.begin(), name.end())] = ordered_json::from_cbor(getBytes(blob, pos));
+  }
+  if (pos != blob.size()) {
+    throw std::runtime_error("Error: Fides proof envelope has trailing bytes");
+  }
+  return proof;
+}
+
+// Function to serialise a telemetry document; data.proof, if present, is packed
+std::string encodeTelemetry(const ordered_json& doc, PayloadFormat format) {
+  if (format == PayloadFormat::Json) {
+    return doc.dump(4);
+  }
+
+  ordered_json envelope = doc;
+  if (envelope.contains("data") && envelope["data"].contains("proof")) {
+    envelope["data"]["proof"] = ordered_json::binary(packProof(doc["data"]["proof"]));
+  }
+  vector<uint8_t> bytes = format == PayloadFormat::Cbor ? ordered_json::to_cbor(envelope) : ordered_json::to_msgpack(envelope);
+  return std::string(bytes.begin(), bytes.end());
+}
+
+// Function to decode a telemetry document; a packed data.proof is unpacked again
+ordered_json decodeTelemetry(const std::string& payload, PayloadFormat format) {
+  if (format == PayloadFormat::Json) {
+    return ordered_json::parse(payload);
+  }
+
+  ordered_json doc = format == PayloadFormat::Cbor ? ordered_json::from_cbor(payload) : ordered_json::from_msgpack(payload);
+  if (doc.contains("data") && doc["data"].contains("proof") && doc["data"]["proof"].is_binary()) {
+    doc["data"]["proof"] = unpackProof(doc["data"]["proof"].get_binary());
+  }
+  return doc;
+}
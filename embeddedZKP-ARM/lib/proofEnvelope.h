@@ -0,0 +1,50 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PROOF_ENVELOPE_H
+#define PROOF_ENVELOPE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "json.hpp"
+
+using namespace std;
+using ordered_json = nlohmann::ordered_json;
+
+// Wire formats for the telemetry document. Json is the readable debug mode;
+// Cbor and MsgPack carry the proof as one packed binary blob.
+enum class PayloadFormat {
+  Json,
+  Cbor,
+  MsgPack
+};
+
+// Function to parse "json", "cbor" or "msgpack"
+PayloadFormat parsePayloadFormat(const std::string& name);
+
+// Function to pack a proof (as written to data/proof.json) into a compact blob
+vector<uint8_t> packProof(const ordered_json& proof);
+
+// Function to unpack a blob produced by packProof
+ordered_json unpackProof(const vector<uint8_t>& blob);
+
+// Function to serialise a telemetry document; data.proof, if present, is packed
+std::string encodeTelemetry(const ordered_json& doc, PayloadFormat format);
+
+// Function to decode a telemetry document; a packed data.proof is unpacked again
+ordered_json decodeTelemetry(const std::string& payload, PayloadFormat format);
+
+#endif  // PROOF_ENVELOPE_H
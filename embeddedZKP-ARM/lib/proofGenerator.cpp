@@ -14,6 +14,9 @@
 
 
 #include "fidesinnova.h"
+#include "asyncProver.h"
+#include "blindingPool.h"
+#include "srs.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -29,7 +32,65 @@ using namespace chrono;
 
 extern "C" void store_register_instances();
 
-extern "C" void proofGenerator() {
+extern uint64_t z_array[];
+
+// Function to generate the witness-independent randomness of one proof
+BlindingBundle generateBlindingBundle() {
+  nlohmann::json commitmentJsonData;
+  std::ifstream commitmentJsonFile("data/program_commitment.json");
+  commitmentJsonFile >> commitmentJsonData;
+  uint64_t Class = commitmentJsonData["class"].get<uint64_t>();
+
+  nlohmann::json classJsonData;
+  std::ifstream classJsonFile("class.json");
+  classJsonFile >> classJsonData;
+  string class_value = to_string(Class);
+  uint64_t n_g = classJsonData[class_value]["n_g"].get<uint64_t>();
+  uint64_t n_i = classJsonData[class_value]["n_i"].get<uint64_t>();
+  uint64_t n   = classJsonData[class_value]["n"].get<uint64_t>();
+  uint64_t p   = classJsonData[class_value]["p"].get<uint64_t>();
+  uint64_t g   = classJsonData[class_value]["g"].get<uint64_t>();
+
+  CommitmentKey ck = loadCommitmentKey(Class, p, g, ahpDegree(n_g, n_i));
+
+  BlindingBundle bundle;
+  bundle.Class = Class;
+
+  uint64_t upper_limit = (n_g < 10) ? n_g - 1 : 9;
+  std::random_device rd;
+  std::mt19937_64 gen(rd());
+  std::uniform_int_distribution<uint64_t> dis(0, upper_limit);
+  bundle.b = dis(gen);
+
+  vector<uint64_t> H;
+  H.push_back(1);
+  uint64_t w = Polynomial::power(g, ((p - 1) / n) % p, p);
+  for (uint64_t i = 1; i < n; i++) {
+    H.push_back(Polynomial::power(w, i, p));
+  }
+
+  for (int64_t i = 0; i < bundle.b; i++) {
+    bundle.extraPoints.push_back(Polynomial::generateRandomNumber(H, p - n));
+    bundle.zA_extra.push_back(Polynomial::generateRandomNumber(H, p - n));
+    bundle.zB_extra.push_back(Polynomial::generateRandomNumber(H, p - n));
+    bundle.zC_extra.push_back(Polynomial::generateRandomNumber(H, p - n));
+    bundle.w_hat_extra.push_back(Polynomial::generateRandomNumber(H, p));
+  }
+
+  bundle.s_x = Polynomial::generateRandomPolynomial(n, (2*n)+bundle.b-1, p);
+  bundle.sigma1 = Polynomial::sumOfEvaluations(bundle.s_x, H, p);
+  bundle.Com_s_x = Polynomial::KZG_Commitment(ck, bundle.s_x, p);
+  return bundle;
+}
+
+// Function to get the pool of blinding bundles prepared ahead of the code block
+BlindingPool& blindingPool() {
+  static BlindingPool pool(8, generateBlindingBundle);
+  return pool;
+}
+
+// Function to generate a proof from a snapshot of z_array
+ordered_json generateProof(const vector<uint64_t>& witness) {
   cout << "\n\n\n\n*** Start proof generation ***" << endl;
 
   // Hardcoded file path
@@ -132,60 +193,63 @@ extern "C" void proofGenerator() {
   p   = classJsonData[class_value]["p"].get<uint64_t>();
   g   = classJsonData[class_value]["g"].get<uint64_t>();
 
-  uint64_t upper_limit = (n_g < 10) ? n_g - 1 : 9;
-  // Set up random number generation
-  std::random_device rd;  // Seed
-  std::mt19937_64 gen(rd()); // Random number engine
-  std::uniform_int_distribution<uint64_t> dis(0, upper_limit);
-  int64_t b = dis(gen);
-
-  // Hardcoded file path
-  std::string setupJsonFilePath = "data/setup" + class_value + ".json";
-  const char* setupJsonFilePathCStr = setupJsonFilePath.c_str();
-
-  // Parse the JSON file
-  nlohmann::json setupJsonData;
-  try {
-      std::ifstream setupJsonFile(setupJsonFilePath);
-      setupJsonFile >> setupJsonData;
-      setupJsonFile.close();
-  } catch (nlohmann::json::parse_error& e) {
-    cout << "Enter the content of setup" << class_value << ".json file! (end with a blank line):" << endl;
-    string setupJsonInput;
-    string setupJsonLines;
-    while (getline(cin, setupJsonLines)) {
-      if (setupJsonLines.empty()) break;
-      setupJsonInput += setupJsonLines + "\n";
+  // A prefix of data/srs.bin when it has one for this class; otherwise the
+  // per-class setup file
+  CommitmentKey ck;
+  if (!universalSRS().find(p, g, ahpDegree(n_g, n_i), ck)) {
+    // Hardcoded file path
+    std::string setupJsonFilePath = "data/setup" + class_value + ".json";
+    const char* setupJsonFilePathCStr = setupJsonFilePath.c_str();
+
+    // Parse the JSON file
+    nlohmann::json setupJsonData;
+    try {
+        std::ifstream setupJsonFile(setupJsonFilePath);
+        setupJsonFile >> setupJsonData;
+        setupJsonFile.close();
+    } catch (nlohmann::json::parse_error& e) {
+      cout << "Enter the content of setup" << class_value << ".json file! (end with a blank line):" << endl;
+      string setupJsonInput;
+      string setupJsonLines;
+      while (getline(cin, setupJsonLines)) {
+        if (setupJsonLines.empty()) break;
+        setupJsonInput += setupJsonLines + "\n";
+      }
+      setupJsonData = nlohmann::json::parse(setupJsonInput);
+        // std::cerr << "Error: " << e.what() << std::endl;
+        // return;
     }
-    setupJsonData = nlohmann::json::parse(setupJsonInput);
-      // std::cerr << "Error: " << e.what() << std::endl;
-      // return;
+    ck = commitmentKeyOf(setupJsonData["ck"].get<vector<uint64_t>>(), setupJsonData["vk"].get<uint64_t>());
   }
-  vector<uint64_t> ck = setupJsonData["ck"].get<vector<uint64_t>>();
-  uint64_t vk = setupJsonData["vk"].get<uint64_t>();
+  uint64_t vk = ck.vk;
 
 
   // Measure the start time
   auto start_time = high_resolution_clock::now();
 
-  extern uint64_t z_array[];
-  
+  // s_x, sigma1, its commitment and the extra interpolation points were
+  // prepared offline; only witness-dependent work is left
+  BlindingBundle bundle = blindingPool().take(Class);
+  int64_t b = bundle.b;
+
   vector<uint64_t> z;
   for(uint64_t i = 0; i < (1 + n_i + n_g); i++) {
-    cout << "z_array" << "[" << i << "] = " << z_array[i] % p << endl;
-    int64_t bufferZ = z_array[i] % p;
+    FIDES_LOG(LogLevel::Trace, "z_array" << "[" << i << "] = " << witness[i] % p);
+    int64_t bufferZ = witness[i] % p;
     if (bufferZ < 0) {
       bufferZ += p;
     }
     z.push_back(bufferZ);
   }
 
-  cout << "\n\n" << endl;
-  cout << "z" << "[";
-  for(uint64_t i = 0; i < (1 + n_i + n_g); i++) {
-    cout << z[i] << ", ";
+  DebugDump::instance().write("z", z);
+  if (logEnabled(LogLevel::Debug)) {
+    cout << "z" << "[";
+    for(uint64_t i = 0; i < (1 + n_i + n_g); i++) {
+      cout << z[i] << ", ";
+    }
+    cout << "]" << endl;
   }
-  cout << "]" << endl;
 
   uint64_t t = n_i + 1;
 
@@ -238,11 +302,14 @@ extern "C" void proofGenerator() {
   for (uint64_t i = 1; i < n; i++) {
     H.push_back(Polynomial::power(w, i, p));
   }
-  cout << "H[n]: ";
-  for (uint64_t i = 0; i < n; i++) {
-    cout << H[i] << " ";
+  DebugDump::instance().write("H", H);
+  if (logEnabled(LogLevel::Debug)) {
+    cout << "H[n]: ";
+    for (uint64_t i = 0; i < n; i++) {
+      cout << H[i] << " ";
+    }
+    cout << endl;
   }
-  cout << endl;
   
   uint64_t y, g_m;
 
@@ -253,11 +320,14 @@ extern "C" void proofGenerator() {
   for (uint64_t i = 1; i < m; i++) {
     K.push_back(Polynomial::power(y, i, p));
   }
-  cout << "K[m]: ";
-  for (uint64_t i = 0; i < m; i++) {
-    cout << K[i] << " ";
+  DebugDump::instance().write("K", K);
+  if (logEnabled(LogLevel::Debug)) {
+    cout << "K[m]: ";
+    for (uint64_t i = 0; i < m; i++) {
+      cout << K[i] << " ";
+    }
+    cout << endl;
   }
-  cout << endl;
 
 
   vector<vector<uint64_t>> Az(n, vector<uint64_t>(1, 0));
@@ -303,8 +373,8 @@ extern "C" void proofGenerator() {
       zA[0].push_back(H[i]);
       zA[1].push_back(Az[i][0]);
     } else {
-      zA[0].push_back(Polynomial::generateRandomNumber(H, p - n));
-      zA[1].push_back(Polynomial::generateRandomNumber(H, p - n));
+      zA[0].push_back(bundle.extraPoints[i - n]);
+      zA[1].push_back(bundle.zA_extra[i - n]);
     }
     // cout << "zA(" << zA[0][i] << ")= " << zA[1][i] << endl;
   }
@@ -321,7 +391,7 @@ extern "C" void proofGenerator() {
       zB[1].push_back(Bz[i][0]);
     } else {
       zB[0].push_back(zA[0][i]);
-      zB[1].push_back(Polynomial::generateRandomNumber(H, p - n));
+      zB[1].push_back(bundle.zB_extra[i - n]);
     }
     // cout << "zB(" << zB[0][i] << ")= " << zB[1][i] << endl;
   }
@@ -336,7 +406,7 @@ extern "C" void proofGenerator() {
       zC[1].push_back(Cz[i][0]);
     } else {
       zC[0].push_back(zA[0][i]);
-      zC[1].push_back(Polynomial::generateRandomNumber(H, p - n));
+      zC[1].push_back(bundle.zC_extra[i - n]);
     }
     // cout << "zC(" << zC[0][i] << ")= " << zC[1][i] << endl;
   }
@@ -392,7 +462,7 @@ extern "C" void proofGenerator() {
   }
   for (uint64_t i = n; i < n + b; i++) {
     w_hat[0].push_back(zA[0][i]);
-    w_hat[1].push_back(Polynomial::generateRandomNumber(H, p));
+    w_hat[1].push_back(bundle.w_hat_extra[i - n]);
     // cout << "w_hat(" << w_hat[0][i - b] << ")= " << w_hat[1][i - b] << endl;
   }
   vector<uint64_t> w_hat_x = Polynomial::setupNewtonPolynomial(w_hat[0], w_hat[1], p, "w_hat(x)");
@@ -420,11 +490,11 @@ extern "C" void proofGenerator() {
   vector<uint64_t> h_0_x = Polynomial::dividePolynomials(zAzB_zC, vH_x, p)[0];
   Polynomial::printPolynomial(h_0_x, "h0(x)");
 
-  vector<uint64_t> s_x = Polynomial::generateRandomPolynomial(n, (2*n)+b-1, p);
+  vector<uint64_t> s_x = bundle.s_x;
   // vector<uint64_t> s_x = { 115, 3, 0, 0, 20, 1, 0, 17, 101, 0, 5 };
   Polynomial::printPolynomial(s_x, "s(x)");
 
-  uint64_t sigma1 = Polynomial::sumOfEvaluations(s_x, H, p);
+  uint64_t sigma1 = bundle.sigma1;
   cout << "sigma1 = " << sigma1 << endl;
 
   uint64_t alpha = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 0, p), p);
@@ -767,7 +837,7 @@ extern "C" void proofGenerator() {
   uint64_t Com4_AHP_x = Polynomial::KZG_Commitment(ck, z_hatB, p);
   uint64_t Com5_AHP_x = Polynomial::KZG_Commitment(ck, z_hatC, p);
   uint64_t Com6_AHP_x = Polynomial::KZG_Commitment(ck, h_0_x, p);
-  uint64_t Com7_AHP_x = Polynomial::KZG_Commitment(ck, s_x, p);
+  uint64_t Com7_AHP_x = bundle.Com_s_x;
   uint64_t Com8_AHP_x = Polynomial::KZG_Commitment(ck, g_1_x, p);
   uint64_t Com9_AHP_x = Polynomial::KZG_Commitment(ck, h_1_x, p);
   uint64_t Com10_AHP_x = Polynomial::KZG_Commitment(ck, g_2_x, p);
@@ -849,4 +919,38 @@ extern "C" void proofGenerator() {
   } else {
       // std::cerr << "Error opening file for writing proof.json\n";
   }
+  return proof;
+}
+
+// Function to get the witness length (1 + n_i + n_g) of the committed class
+uint64_t witnessLength() {
+  static const uint64_t length = [] {
+    nlohmann::json commitmentJsonData;
+    std::ifstream commitmentJsonFile("data/program_commitment.json");
+    commitmentJsonFile >> commitmentJsonData;
+    nlohmann::json classJsonData;
+    std::ifstream classJsonFile("class.json");
+    classJsonFile >> classJsonData;
+    string class_value = to_string(commitmentJsonData["class"].get<uint64_t>());
+    return 1 + classJsonData[class_value]["n_i"].get<uint64_t>() + classJsonData[class_value]["n_g"].get<uint64_t>();
+  }();
+  return length;
+}
+
+// Function to get the background prover shared by the code block and the main loop
+AsyncProver& fidesProver() {
+  // Start filling the blinding pool as soon as the program sets up the prover,
+  // and make sure the pool outlives the prover thread that draws from it
+  blindingPool();
+  // A few pending snapshots are enough to ride out a burst of readings
+  static AsyncProver prover(4, generateProof);
+  return prover;
+}
+
+// Called by the instrumented code block: snapshot the witness and return
+extern "C" void proofGenerator() {
+  vector<uint64_t> witness(z_array, z_array + witnessLength());
+  if (!fidesProver().submit(std::move(witness))) {
+    cerr << "Prover is busy, dropped the oldest pending witness" << endl;
+  }
 }
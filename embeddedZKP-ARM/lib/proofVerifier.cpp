@@ -0,0 +1,207 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "proofVerifier.h"
+#include "polynomial.h"
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+
+bool ProofEquations::holds() const {
+  for (int i = 0; i < 5; i++) {
+    if (left[i] != right[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Function to multiply in F_p without overflowing for primes above 2^32
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p) {
+  return uint64_t((unsigned __int128)a * b % p);
+}
+
+VerifyingKey loadVerifyingKey(const string& commitmentPath, const string& classPath) {
+  cout << "openning " << commitmentPath << endl;
+  std::ifstream commitmentFileStream(commitmentPath);
+  if (!commitmentFileStream.is_open()) {
+    throw std::runtime_error("Error: Fides cannot open " + commitmentPath);
+  }
+  nlohmann::json commitmentJsonData;
+  commitmentFileStream >> commitmentJsonData;
+  commitmentFileStream.close();
+
+  cout << "openning " << classPath << endl;
+  std::ifstream classFileStream(classPath);
+  if (!classFileStream.is_open()) {
+    throw std::runtime_error("Error: Fides cannot open " + classPath);
+  }
+  nlohmann::json classJsonData;
+  classFileStream >> classJsonData;
+  classFileStream.close();
+
+  return cachedVerifyingKey(commitmentJsonData, classJsonData);
+}
+
+ProofEquations evaluateProof(const VerifyingKey& key, const ordered_json& proofJsonData) {
+  uint64_t n = key.n, p = key.p, g = key.g;
+
+  uint64_t sigma1 =           proofJsonData["P_AHP1"].get<uint64_t>();
+  vector<uint64_t> w_hat_x =  proofJsonData["P_AHP2"].get<vector<uint64_t>>();
+  vector<uint64_t> z_hatA =   proofJsonData["P_AHP3"].get<vector<uint64_t>>();
+  vector<uint64_t> z_hatB =   proofJsonData["P_AHP4"].get<vector<uint64_t>>();
+  vector<uint64_t> z_hatC =   proofJsonData["P_AHP5"].get<vector<uint64_t>>();
+  vector<uint64_t> h_0_x =    proofJsonData["P_AHP6"].get<vector<uint64_t>>();
+  vector<uint64_t> s_x =      proofJsonData["P_AHP7"].get<vector<uint64_t>>();
+  vector<uint64_t> g_1_x =    proofJsonData["P_AHP8"].get<vector<uint64_t>>();
+  vector<uint64_t> h_1_x =    proofJsonData["P_AHP9"].get<vector<uint64_t>>();
+  uint64_t sigma2 =           proofJsonData["P_AHP10"].get<uint64_t>();
+  vector<uint64_t> g_2_x =    proofJsonData["P_AHP11"].get<vector<uint64_t>>();
+  vector<uint64_t> h_2_x =    proofJsonData["P_AHP12"].get<vector<uint64_t>>();
+  uint64_t sigma3 =           proofJsonData["P_AHP13"].get<uint64_t>();
+  vector<uint64_t> g_3_x =    proofJsonData["P_AHP14"].get<vector<uint64_t>>();
+  vector<uint64_t> h_3_x =    proofJsonData["P_AHP15"].get<vector<uint64_t>>();
+  uint64_t y_prime =          proofJsonData["P_AHP16"].get<uint64_t>();
+  uint64_t p_17_AHP =         proofJsonData["P_AHP17"].get<uint64_t>();
+
+  vector<uint64_t> Com1_AHP_x = proofJsonData["Com_AHP1_x"].get<vector<uint64_t>>();
+  uint64_t Com2_AHP_x = proofJsonData["Com_AHP2_x"].get<uint64_t>();
+  uint64_t Com3_AHP_x = proofJsonData["Com_AHP3_x"].get<uint64_t>();
+  uint64_t Com4_AHP_x = proofJsonData["Com_AHP4_x"].get<uint64_t>();
+  uint64_t Com5_AHP_x = proofJsonData["Com_AHP5_x"].get<uint64_t>();
+  uint64_t Com6_AHP_x = proofJsonData["Com_AHP6_x"].get<uint64_t>();
+  uint64_t Com7_AHP_x = proofJsonData["Com_AHP7_x"].get<uint64_t>();
+  uint64_t Com8_AHP_x = proofJsonData["Com_AHP8_x"].get<uint64_t>();
+  uint64_t Com9_AHP_x = proofJsonData["Com_AHP9_x"].get<uint64_t>();
+  uint64_t Com10_AHP_x = proofJsonData["Com_AHP10_x"].get<uint64_t>();
+  uint64_t Com11_AHP_x = proofJsonData["Com_AHP11_x"].get<uint64_t>();
+  uint64_t Com12_AHP_x = proofJsonData["Com_AHP12_x"].get<uint64_t>();
+  uint64_t Com13_AHP_x = proofJsonData["Com_AHP13_x"].get<uint64_t>();
+
+  uint64_t x_prime = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 22, p), p);
+
+  uint64_t alpha = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 0, p), p);
+  uint64_t etaA = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 1, p), p);
+  uint64_t etaB = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 2, p), p);
+  uint64_t etaC = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 3, p), p);
+
+  uint64_t beta1 = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 8, p), p);
+  uint64_t beta2 = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 9, p), p);
+  uint64_t beta3 = Polynomial::generateRandomNumber({0}, 1000);
+
+  uint64_t eta_w_hat = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 10, p), p);
+  uint64_t eta_z_hatA = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 11, p), p);
+  uint64_t eta_z_hatB = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 12, p), p);
+  uint64_t eta_z_hatC = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 13, p), p);
+  uint64_t eta_h_0_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 14, p), p);
+  uint64_t eta_s_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 15, p), p);
+  uint64_t eta_g_1_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 16, p), p);
+  uint64_t eta_h_1_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 17, p), p);
+  uint64_t eta_g_2_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 18, p), p);
+  uint64_t eta_h_2_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 19, p), p);
+  uint64_t eta_g_3_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 20, p), p);
+  uint64_t eta_h_3_x = Polynomial::hashAndExtractLower4Bytes(Polynomial::evaluatePolynomial(s_x, 21, p), p);
+
+  uint64_t vH_beta1 = key.vH(beta1);
+  FIDES_LOG(LogLevel::Debug, "vH(beta1) = " << vH_beta1);
+
+  uint64_t vH_beta2 = key.vH(beta2);
+  FIDES_LOG(LogLevel::Debug, "vH(beta2) = " << vH_beta2);
+
+  // a(x) and b(x) are only needed at beta3, so each row/col/val polynomial is
+  // evaluated there and the scalars are combined with the same formulas:
+  //   pi_M = (row_M(beta3) - beta2) * (col_M(beta3) - beta1)
+  //   sig_M = eta_M * vH(beta2) * vH(beta1) * val_M(beta3)
+  //   a = sig_A * pi_B * pi_C + sig_B * pi_A * pi_C + sig_C * pi_A * pi_B
+  //   b = pi_A * pi_B * pi_C
+  auto pi = [&](const vector<uint64_t>& row_x, const vector<uint64_t>& col_x) {
+    return mulMod(Polynomial::subtractModP(Polynomial::evaluatePolynomial(row_x, beta3, p), beta2 % p, p),
+                  Polynomial::subtractModP(Polynomial::evaluatePolynomial(col_x, beta3, p), beta1 % p, p), p);
+  };
+  uint64_t vH_B2_vH_B1 = mulMod(vH_beta2, vH_beta1, p);
+  auto sig = [&](uint64_t eta, const vector<uint64_t>& val_x) {
+    return mulMod(mulMod(eta, vH_B2_vH_B1, p), Polynomial::evaluatePolynomial(val_x, beta3, p), p);
+  };
+  uint64_t pi_a = pi(key.rowA_x, key.colA_x);
+  uint64_t pi_b = pi(key.rowB_x, key.colB_x);
+  uint64_t pi_c = pi(key.rowC_x, key.colC_x);
+  uint64_t sig_a = sig(etaA, key.valA_x);
+  uint64_t sig_b = sig(etaB, key.valB_x);
+  uint64_t sig_c = sig(etaC, key.valC_x);
+
+  uint64_t a_beta3 = (mulMod(sig_a, mulMod(pi_b, pi_c, p), p) + mulMod(sig_b, mulMod(pi_a, pi_c, p), p) + mulMod(sig_c, mulMod(pi_a, pi_b, p), p)) % p;
+  uint64_t b_beta3 = mulMod(mulMod(pi_a, pi_b, p), pi_c, p);
+  FIDES_LOG(LogLevel::Debug, "a(beta3) = " << a_beta3);
+  FIDES_LOG(LogLevel::Debug, "b(beta3) = " << b_beta3);
+
+  vector<uint64_t> r_alpha_x = Polynomial::calculatePolynomial_r_alpha_x(alpha, n, p);
+  uint64_t z_hatA_beta1 = Polynomial::evaluatePolynomial(z_hatA, beta1, p);
+  uint64_t z_hatB_beta1 = Polynomial::evaluatePolynomial(z_hatB, beta1, p);
+  uint64_t z_hatC_beta1 = Polynomial::evaluatePolynomial(z_hatC, beta1, p);
+  uint64_t Sum_M_eta_M_z_hat_M_beta1 = (mulMod(etaA, z_hatA_beta1, p) + mulMod(etaB, z_hatB_beta1, p) + mulMod(etaC, z_hatC_beta1, p)) % p;
+
+  vector<uint64_t> zero_to_t_for_z;
+  zero_to_t_for_z.push_back(1);
+  for (int i = 0; i < 32; i++) {
+    zero_to_t_for_z.push_back(Com1_AHP_x[i]);
+  }
+
+  // z_hat(x) = w_hat(x) * v_H(x) + x_hat(x), needed only at beta1
+  uint64_t x_hat_beta1 = key.interpolate(zero_to_t_for_z, beta1);
+  uint64_t z_hat_beta1 = (mulMod(Polynomial::evaluatePolynomial(w_hat_x, beta1, p), Polynomial::evaluatePolynomial(key.v_H, beta1, p), p) + x_hat_beta1) % p;
+  FIDES_LOG(LogLevel::Debug, "x_hat(beta1) = " << x_hat_beta1);
+
+  uint64_t ComP_AHP_x = ((Com2_AHP_x * eta_w_hat) % p + ((Com3_AHP_x * eta_z_hatA) % p + ((Com4_AHP_x * eta_z_hatB) % p + ((Com5_AHP_x * eta_z_hatC) % p + ((Com6_AHP_x * eta_h_0_x) % p + ((Com7_AHP_x * eta_s_x) % p + ((Com8_AHP_x * eta_g_1_x) % p + ((Com9_AHP_x * eta_h_1_x) % p + ((Com10_AHP_x * eta_g_2_x) % p + ((Com11_AHP_x * eta_h_2_x) % p + ((Com12_AHP_x * eta_g_3_x) % p + (Com13_AHP_x * eta_h_3_x) % p) % p) %p) % p) % p) % p) % p) % p) % p) % p) % p) % p;
+  FIDES_LOG(LogLevel::Debug, "ComP_AHP_x = " << ComP_AHP_x);
+
+  Polynomial::printPolynomial(g_3_x, "g_3_x");
+  FIDES_LOG(LogLevel::Debug, "beta3 = " << beta3);
+  FIDES_LOG(LogLevel::Debug, "sigma3 = " << sigma3);
+
+  ProofEquations equations;
+  equations.left[0] = (Polynomial::evaluatePolynomial(h_3_x, beta3, p) * key.vK(beta3)) % p;
+  equations.right[0] = Polynomial::subtractModP(a_beta3, ((b_beta3 * (beta3 * Polynomial::evaluatePolynomial(g_3_x, beta3, p) + (sigma3 * key.mInverse) % p))), p);
+
+  equations.left[1] = (Polynomial::evaluatePolynomial(r_alpha_x, beta2, p) * sigma3) % p;
+  equations.right[1] = ((Polynomial::evaluatePolynomial(h_2_x, beta2, p) * vH_beta2) % p + (beta2 * Polynomial::evaluatePolynomial(g_2_x, beta2, p)) % p + (sigma2 * key.nInverse) % p) % p;
+
+  equations.left[2] = Polynomial::subtractModP(Polynomial::evaluatePolynomial(s_x, beta1, p) + Polynomial::evaluatePolynomial(r_alpha_x, beta1, p) * Sum_M_eta_M_z_hat_M_beta1, (sigma2 * z_hat_beta1), p);
+  equations.right[2] = (Polynomial::evaluatePolynomial(h_1_x, beta1, p) * vH_beta1 + beta1 * Polynomial::evaluatePolynomial(g_1_x, beta1, p) + sigma1 * key.nInverse) % p;
+
+  equations.left[3] = Polynomial::subtractModP(((z_hatA_beta1 * z_hatB_beta1) % p), z_hatC_beta1, p);
+  equations.right[3] = (Polynomial::evaluatePolynomial(h_0_x, beta1, p) * vH_beta1) % p;
+
+  uint64_t eq51Buf = Polynomial::subtractModP(ComP_AHP_x, (g * y_prime), p);
+  equations.left[4] = Polynomial::e_func(eq51Buf, g, g, p);
+  uint64_t eq52BufP2 = Polynomial::subtractModP(key.vk, (g * x_prime), p);
+  equations.right[4] = Polynomial::e_func(p_17_AHP, eq52BufP2, g, p);
+  return equations;
+}
+
+bool verifyBatch(const VerifyingKey& key, const vector<ordered_json>& proofs, vector<size_t>& failed) {
+  failed.clear();
+  for (size_t i = 0; i < proofs.size(); i++) {
+    // A proof for another commitment is not evaluated against this key
+    if (!key.commitmentId.empty() && proofs[i].contains("commitmentId") &&
+        proofs[i]["commitmentId"].get<string>() != key.commitmentId) {
+      failed.push_back(i);
+      continue;
+    }
+    if (!evaluateProof(key, proofs[i]).holds()) {
+      failed.push_back(i);
+    }
+  }
+  return failed.empty();
+}
@@ -0,0 +1,51 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PROOF_VERIFIER_H
+#define PROOF_VERIFIER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "json.hpp"
+#include "verifyingKey.h"
+using ordered_json = nlohmann::ordered_json;
+
+using namespace std;
+
+// Left and right sides of the five verifier equations for one proof
+struct ProofEquations {
+  uint64_t left[5] = { 0 };
+  uint64_t right[5] = { 0 };
+
+  bool holds() const;
+};
+
+// Function to read data/program_commitment.json and class.json and get their
+// verifying key, from data/vk when it was prepared before
+VerifyingKey loadVerifyingKey(const string& commitmentPath = "data/program_commitment.json", const string& classPath = "class.json");
+
+// Function to evaluate the five equations of one proof
+ProofEquations evaluateProof(const VerifyingKey& key, const ordered_json& proof);
+
+// Function to check a batch of proofs against one commitment. Only the
+// verifying key is shared; there is no aggregated check. Every equation is a
+// comparison of two scalars, so each proof is checked on its own; folding them
+// into one random linear combination would cost more and could accept a bad
+// proof. The indices of the failing proofs are put in failed.
+bool verifyBatch(const VerifyingKey& key, const vector<ordered_json>& proofs, vector<size_t>& failed);
+
+#endif  // PROOF_VERIFIER_H
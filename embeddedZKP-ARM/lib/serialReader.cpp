@@ -0,0 +1,258 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "serialReader.h"
+#include <iostream>
+#include <cerrno>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+
+SerialReader::SerialReader(Framing framing, size_t capacity) : framing(framing) {
+  // Round the capacity up to a power of two so positions wrap with a mask
+  size_t size = 64;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  ring.resize(size);
+  mask = size - 1;
+}
+
+SerialReader::~SerialReader() {
+  if (epollFd != -1) {
+    close(epollFd);
+  }
+  if (ownsFd && fd != -1) {
+    close(fd);
+  }
+}
+
+// Function to open and configure a serial port
+int SerialReader::open(const std::string& port) {
+  int portFd = ::open(port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (portFd == -1) {
+    std::cerr << "Error: Unable to open serial port" << std::endl;
+    return -1;
+  }
+
+  struct termios tty;
+  if (tcgetattr(portFd, &tty) != 0) {
+    std::cerr << "Error: Failed to get terminal attributes" << std::endl;
+    close(portFd);
+    return -1;
+  }
+
+  cfsetospeed(&tty, B115200);
+  cfsetispeed(&tty, B115200);
+  tty.c_cflag |= (CLOCAL | CREAD);
+  tty.c_cflag &= ~PARENB;
+  tty.c_cflag &= ~CSTOPB;
+  tty.c_cflag &= ~CSIZE;
+  tty.c_cflag |= CS8;
+  tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
+  tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+  tty.c_oflag &= ~OPOST;
+  tcsetattr(portFd, TCSANOW, &tty);
+
+  if (!attach(portFd)) {
+    close(portFd);
+    return -1;
+  }
+  ownsFd = true;
+  return portFd;
+}
+
+// Function to read from an already opened descriptor
+bool SerialReader::attach(int descriptor) {
+  int flags = fcntl(descriptor, F_GETFL, 0);
+  if (flags == -1 || fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) == -1) {
+    std::cerr << "Error: Failed to make the serial port non-blocking" << std::endl;
+    return false;
+  }
+
+  epollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd == -1) {
+    std::cerr << "Error: Failed to create epoll instance" << std::endl;
+    return false;
+  }
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = descriptor;
+  if (epoll_ctl(epollFd, EPOLL_CTL_ADD, descriptor, &event) == -1) {
+    std::cerr << "Error: Failed to watch the serial port" << std::endl;
+    close(epollFd);
+    epollFd = -1;
+    return false;
+  }
+  fd = descriptor;
+  return true;
+}
+
+// Function to wait for the next complete message
+bool SerialReader::next(nlohmann::json& message, int timeoutMs) {
+  while (true) {
+    while (frames.empty()) {
+      if (hangup || !fill(timeoutMs)) {
+        return false;
+      }
+      extractFrames();
+    }
+
+    std::string frame = std::move(frames.front());
+    frames.pop_front();
+    try {
+      message = nlohmann::json::parse(frame);
+      return true;
+    } catch (nlohmann::json::parse_error& e) {
+      badFrames++;
+      std::cerr << "JSON Parse Error: " << e.what() << std::endl;
+    }
+  }
+}
+
+// Sleep in epoll until the port is readable, then drain it into the ring
+bool SerialReader::fill(int timeoutMs) {
+  if (epollFd == -1) {
+    return false;
+  }
+
+  // A frame larger than the ring can never complete: drop it and resync
+  if (tail - head == ring.size()) {
+    std::cerr << "Serial frame exceeds " << ring.size() << " bytes, discarding buffered input" << std::endl;
+    overflowCount++;
+    head = scan = tail;
+    depth = 0;
+    inString = escaped = false;
+  }
+
+  struct epoll_event event;
+  int ready = epoll_wait(epollFd, &event, 1, timeoutMs);
+  if (ready <= 0) {
+    return false;
+  }
+
+  bool gotData = false;
+  while (tail - head < ring.size()) {
+    uint64_t space = ring.size() - (tail - head);
+    uint64_t start = tail & mask;
+    uint64_t first = std::min<uint64_t>(space, ring.size() - start);
+    struct iovec chunks[2] = {
+      { &ring[start], first },
+      { &ring[0], space - first }
+    };
+    ssize_t bytes = readv(fd, chunks, space > first ? 2 : 1);
+    if (bytes > 0) {
+      tail += bytes;
+      gotData = true;
+      continue;
+    }
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    // EOF, or EIO once the other end of a pseudo-terminal is closed
+    hangup = true;
+    break;
+  }
+  if (!gotData && (event.events & (EPOLLHUP | EPOLLERR))) {
+    hangup = true;
+  }
+  return gotData;
+}
+
+// Scan the newly received bytes and queue every complete frame
+void SerialReader::extractFrames() {
+  if (framing == Framing::Newline) {
+    for (; scan < tail; scan++) {
+      if (at(scan) == '\n') {
+        uint64_t end = scan;
+        if (end > head && at(end - 1) == '\r') {
+          end--;
+        }
+        if (end > head) {
+          frames.push_back(copyOut(head, end));
+        }
+        head = scan + 1;
+      }
+    }
+  } else if (framing == Framing::LengthPrefixed) {
+    while (tail - head >= 4) {
+      uint64_t length = (uint64_t(at(head)) << 24) | (uint64_t(at(head + 1)) << 16) |
+                        (uint64_t(at(head + 2)) << 8) | uint64_t(at(head + 3));
+      if (length > ring.size() - 4) {
+        // A corrupt length cannot be resynchronised; start over with fresh input
+        std::cerr << "Serial frame length " << length << " exceeds the ring buffer, discarding buffered input" << std::endl;
+        overflowCount++;
+        head = tail;
+        break;
+      }
+      if (tail - head < 4 + length) {
+        break;
+      }
+      frames.push_back(copyOut(head + 4, head + 4 + length));
+      head += 4 + length;
+    }
+    scan = head;
+  } else {
+    // Track nesting across reads so a partial object resumes where it stopped
+    for (; scan < tail; scan++) {
+      uint8_t c = at(scan);
+      if (depth == 0) {
+        if (c == '{') {
+          head = scan;
+          depth = 1;
+        } else {
+          head = scan + 1;  // whitespace or noise between objects
+        }
+        continue;
+      }
+      if (inString) {
+        if (escaped) {
+          escaped = false;
+        } else if (c == '\\') {
+          escaped = true;
+        } else if (c == '"') {
+          inString = false;
+        }
+        continue;
+      }
+      if (c == '"') {
+        inString = true;
+      } else if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == '}' || c == ']') {
+        depth--;
+        if (depth == 0) {
+          frames.push_back(copyOut(head, scan + 1));
+          head = scan + 1;
+        }
+      }
+    }
+  }
+}
+
+std::string SerialReader::copyOut(uint64_t from, uint64_t to) const {
+  std::string frame;
+  frame.reserve(to - from);
+  uint64_t start = from & mask;
+  uint64_t first = std::min<uint64_t>(to - from, ring.size() - start);
+  frame.append(reinterpret_cast<const char*>(&ring[start]), first);
+  frame.append(reinterpret_cast<const char*>(&ring[0]), (to - from) - first);
+  return frame;
+}
@@ -0,0 +1,85 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SERIAL_READER_H
+#define SERIAL_READER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdint>
+#include "json.hpp"
+
+using namespace std;
+
+// Event-driven reader for the sensor UART. Bytes land in a ring buffer and are
+// split into frames, so a message may arrive in pieces or several at once.
+class SerialReader {
+public:
+  enum class Framing {
+    Newline,        // one message per '\n' terminated line
+    LengthPrefixed, // 4-byte big-endian length followed by the message
+    JsonObject      // balanced top-level {...} objects, separators ignored
+  };
+
+  SerialReader(Framing framing = Framing::JsonObject, size_t capacity = 4096);
+  ~SerialReader();
+
+  // Function to open and configure a serial port (115200 8N1, raw); returns the fd or -1
+  int open(const std::string& port);
+
+  // Function to read from an already opened descriptor (e.g. a pseudo-terminal)
+  bool attach(int fd);
+
+  // Function to wait up to timeoutMs (-1 blocks) for the next complete message
+  bool next(nlohmann::json& message, int timeoutMs = -1);
+
+  // Function to report whether the peer hung up
+  bool closed() const { return hangup; }
+
+  // Function to get the number of frames that were not valid JSON
+  uint64_t parseErrors() const { return badFrames; }
+
+  // Function to get the number of times a frame outgrew the ring buffer
+  uint64_t overflows() const { return overflowCount; }
+
+private:
+  bool fill(int timeoutMs);
+  void extractFrames();
+  std::string copyOut(uint64_t from, uint64_t to) const;
+  uint8_t at(uint64_t position) const { return ring[position & mask]; }
+
+  Framing framing;
+  vector<uint8_t> ring;
+  uint64_t mask;
+  uint64_t head = 0;    // first unconsumed byte
+  uint64_t tail = 0;    // one past the last received byte
+  uint64_t scan = 0;    // resume point of the frame scanner
+
+  // JsonObject scanner state, kept across reads
+  int depth = 0;
+  bool inString = false;
+  bool escaped = false;
+
+  deque<std::string> frames;
+  int fd = -1;
+  int epollFd = -1;
+  bool ownsFd = false;
+  bool hangup = false;
+  uint64_t badFrames = 0;
+  uint64_t overflowCount = 0;
+};
+
+#endif  // SERIAL_READER_H
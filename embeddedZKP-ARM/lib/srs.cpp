@@ -0,0 +1,196 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "srs.h"
+#include "json.hpp"
+#include "logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+uint64_t ahpDegree(uint64_t n_g, uint64_t n_i) {
+  return max(((12 * n_g) - 6), ((3 * n_g) + (2 * n_i) + 1));
+}
+
+UniversalSRS::~UniversalSRS() {
+  if (data) {
+    munmap(const_cast<char*>(data), size);
+  }
+}
+
+bool UniversalSRS::open(const string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0 || size_t(status.st_size) < sizeof(SrsHeader)) {
+    ::close(fd);
+    return false;
+  }
+  size_t length = size_t(status.st_size);
+  void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+
+  const char* bytes = static_cast<const char*>(mapped);
+  SrsHeader header;
+  memcpy(&header, bytes, sizeof(header));
+  bool valid = memcmp(header.magic, srsMagic, sizeof(srsMagic)) == 0 && header.version == srsVersion &&
+               sizeof(SrsHeader) + uint64_t(header.sectionCount) * sizeof(SrsSection) <= length;
+  vector<SrsSection> table;
+  for (uint32_t i = 0; valid && i < header.sectionCount; i++) {
+    SrsSection section;
+    memcpy(&section, bytes + sizeof(SrsHeader) + i * sizeof(SrsSection), sizeof(section));
+    valid = section.offset % sizeof(uint64_t) == 0 && section.offset <= length &&
+            section.degree <= (length - section.offset) / sizeof(uint64_t);
+    table.push_back(section);
+  }
+  if (!valid) {
+    munmap(mapped, length);
+    return false;
+  }
+
+  if (data) {
+    munmap(const_cast<char*>(data), size);
+  }
+  data = bytes;
+  size = length;
+  sections = table;
+  return true;
+}
+
+bool UniversalSRS::find(uint64_t p, uint64_t g, uint64_t degree, CommitmentKey& key) const {
+  for (const auto& section : sections) {
+    if (section.p == p && section.g == g && section.degree >= degree && degree > 1) {
+      key.data = reinterpret_cast<const uint64_t*>(data + section.offset);
+      key.size = degree;
+      key.vk = key.data[1];
+      key.storage.reset();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SrsWriter::open(const string& path, vector<SrsSection>& sections) {
+  file = fopen(path.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  SrsHeader header;
+  memcpy(header.magic, srsMagic, sizeof(srsMagic));
+  header.version = srsVersion;
+  header.sectionCount = uint32_t(sections.size());
+  uint64_t offset = sizeof(SrsHeader) + sections.size() * sizeof(SrsSection);
+  for (auto& section : sections) {
+    section.offset = offset;
+    offset += section.degree * sizeof(uint64_t);
+  }
+  return fwrite(&header, sizeof(header), 1, file) == 1 &&
+         fwrite(sections.data(), sizeof(SrsSection), sections.size(), file) == sections.size();
+}
+
+bool SrsWriter::append(const uint64_t* values, size_t count) {
+  return file && fwrite(values, sizeof(uint64_t), count, file) == count;
+}
+
+bool SrsWriter::close() {
+  if (!file) {
+    return false;
+  }
+  bool ok = fclose(file) == 0;
+  file = nullptr;
+  return ok;
+}
+
+CommitmentKey commitmentKeyOf(vector<uint64_t> ck, uint64_t vk) {
+  CommitmentKey key;
+  auto storage = make_shared<const vector<uint64_t>>(std::move(ck));
+  key.data = storage->data();
+  key.size = storage->size();
+  key.vk = vk;
+  key.storage = storage;
+  return key;
+}
+
+const UniversalSRS& universalSRS() {
+  static UniversalSRS srs;
+  static bool opened = srs.open(srsFilePath);
+  (void)opened;
+  return srs;
+}
+
+// Function to read the vk of a data/setup<class>.json without keeping its ck
+static bool readSetupVk(const string& path, uint64_t& vk) {
+  std::ifstream setupFileStream(path);
+  if (!setupFileStream.is_open()) {
+    return false;
+  }
+  // Drop the ck elements as they are parsed
+  nlohmann::json setupJsonData = nlohmann::json::parse(setupFileStream, [](int depth, nlohmann::json::parse_event_t event, nlohmann::json&) {
+    return !(depth == 2 && event == nlohmann::json::parse_event_t::value);
+  });
+  vk = setupJsonData["vk"].get<uint64_t>();
+  return true;
+}
+
+CommitmentKey loadCommitmentKey(uint64_t Class, uint64_t p, uint64_t g, uint64_t degree) {
+  string setupFilePath = "data/setup" + to_string(Class) + ".json";
+  CommitmentKey key;
+  if (universalSRS().find(p, g, degree, key)) {
+    // setup --universal rewrites the class files from the same tau; comparing
+    // them costs a scan of the JSON, so it is only done on request
+    uint64_t setupVk;
+    if (getenv("FIDES_CHECK_SETUP") && readSetupVk(setupFilePath, setupVk) && setupVk != key.vk) {
+      throw std::runtime_error("Error: Fides found different setups in " + string(srsFilePath) + " (vk " + to_string(key.vk) + ") and " +
+                               setupFilePath + " (vk " + to_string(setupVk) + "); remove the stale one.\n");
+    }
+    FIDES_LOG(LogLevel::Info, "Setup of class " << Class << " read from " << srsFilePath);
+    return key;
+  }
+
+  std::ifstream setupFileStream(setupFilePath);
+  if (!setupFileStream.is_open()) {
+    throw std::runtime_error("Error: Fides cannot open " + setupFilePath + " for reading proposes, and " + srsFilePath + " has no setup for class " + to_string(Class) + ".\n");
+  }
+  nlohmann::json setupJsonData;
+  setupFileStream >> setupJsonData;
+  FIDES_LOG(LogLevel::Info, "Setup of class " << Class << " read from " << setupFilePath);
+  return commitmentKeyOf(setupJsonData["ck"].get<vector<uint64_t>>(), setupJsonData["vk"].get<uint64_t>());
+}
+
+uint64_t loadSetupVk(uint64_t Class, uint64_t p, uint64_t g, uint64_t degree) {
+  CommitmentKey key;
+  if (universalSRS().find(p, g, degree, key)) {
+    // Mapped, so nothing is copied
+    return loadCommitmentKey(Class, p, g, degree).vk;
+  }
+  string setupFilePath = "data/setup" + to_string(Class) + ".json";
+  uint64_t vk;
+  if (!readSetupVk(setupFilePath, vk)) {
+    throw std::runtime_error("Error: Fides cannot open " + setupFilePath + " for reading proposes, and " + srsFilePath + " has no setup for class " + to_string(Class) + ".\n");
+  }
+  FIDES_LOG(LogLevel::Info, "vk of class " << Class << " read from " << setupFilePath);
+  return vk;
+}
@@ -0,0 +1,125 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SRS_H
+#define SRS_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+using namespace std;
+
+// Universal setup file, data/srs.bin. One section per (p, g) holds
+// ck[i] = g * tau^i for the largest degree any class on that prime needs, and
+// every class is served the prefix it needs straight from the mapped file.
+//
+//   SrsHeader
+//   SrsSection[sectionCount]
+//   uint64_t ck[degree] of each section, at its offset
+const char srsMagic[8] = { 'F', 'I', 'D', 'E', 'S', 'R', 'S', '\0' };
+const uint32_t srsVersion = 1;
+const char srsFilePath[] = "data/srs.bin";
+
+struct SrsHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t sectionCount;
+};
+
+struct SrsSection {
+  uint64_t p;
+  uint64_t g;
+  uint64_t degree;
+  uint64_t offset;    // in bytes from the start of the file
+};
+
+// Commitment key of one class. data points into the mapped srs.bin, or into
+// storage when the key was read from data/setup<class>.json. It converts to a
+// pointer, so ck[i] and Polynomial::KZG_Commitment(ck, ...) work unchanged.
+struct CommitmentKey {
+  const uint64_t* data = nullptr;
+  uint64_t size = 0;
+  uint64_t vk = 0;
+  shared_ptr<const vector<uint64_t>> storage;
+
+  operator const uint64_t*() const { return data; }
+};
+
+// Function to get the degree of ck a class needs
+uint64_t ahpDegree(uint64_t n_g, uint64_t n_i);
+
+class UniversalSRS {
+public:
+  UniversalSRS() = default;
+  ~UniversalSRS();
+  UniversalSRS(const UniversalSRS&) = delete;
+  UniversalSRS& operator=(const UniversalSRS&) = delete;
+
+  // Function to map an SRS file and check its header and sections
+  bool open(const string& path);
+
+  bool isOpen() const { return data != nullptr; }
+
+  // Function to get a view of the first `degree` elements of the section for
+  // (p, g); false if the file has no such section or it is too short
+  bool find(uint64_t p, uint64_t g, uint64_t degree, CommitmentKey& key) const;
+
+  const vector<SrsSection>& sectionList() const { return sections; }
+
+private:
+  const char* data = nullptr;
+  size_t size = 0;
+  vector<SrsSection> sections;
+};
+
+// Writes an SRS file front to back: the section table first, then each
+// section's ck in order, so a key never has to be held in memory as a whole.
+class SrsWriter {
+public:
+  // Function to create the file and write the header and section table;
+  // offsets are filled in from the degrees
+  bool open(const string& path, vector<SrsSection>& sections);
+
+  // Function to append ck elements to the current section
+  bool append(const uint64_t* values, size_t count);
+
+  // Function to flush and close the file
+  bool close();
+
+private:
+  FILE* file = nullptr;
+};
+
+// Function to wrap a ck read from a data/setup<class>.json file
+CommitmentKey commitmentKeyOf(vector<uint64_t> ck, uint64_t vk);
+
+// Function to get the mapped data/srs.bin; not open if there is none
+const UniversalSRS& universalSRS();
+
+// Function to get the commitment key of a class: a prefix of data/srs.bin when
+// it has a section for (p, g), data/setup<Class>.json otherwise. srs.bin stays
+// mapped, so switching classes does not read it again. With FIDES_CHECK_SETUP
+// set, throws when both exist and their vk differ, since one of them is stale.
+CommitmentKey loadCommitmentKey(uint64_t Class, uint64_t p, uint64_t g, uint64_t degree);
+
+// Function to get only the vk of a class's setup, from the same source as
+// loadCommitmentKey; a data/setup<Class>.json is scanned without keeping its ck
+uint64_t loadSetupVk(uint64_t Class, uint64_t p, uint64_t g, uint64_t degree);
+
+#endif  // SRS_H
@@ -0,0 +1,443 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verifierService.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cerrno>
+#include <algorithm>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*******************************  CommitmentCache  ******************************/
+CommitmentCache::CommitmentCache(size_t capacity, Loader loader)
+  : capacity(capacity == 0 ? 1 : capacity), loader(std::move(loader)) {}
+
+// Function to get the verifying key of a commitment, loading it on a miss
+CommitmentCache::Key CommitmentCache::get(const string& commitmentId) {
+  promise<Key> loaded;
+  shared_future<Key> future;
+  bool load = false;
+  {
+    lock_guard<mutex> guard(lock);
+    auto found = index.find(commitmentId);
+    if (found != index.end()) {
+      recent.splice(recent.begin(), recent, found->second);
+      future = found->second->second;
+      hitCount++;
+    } else {
+      future = loaded.get_future().share();
+      recent.emplace_front(commitmentId, future);
+      index[commitmentId] = recent.begin();
+      missCount++;
+      load = true;
+    }
+  }
+  if (!load) {
+    return future.get();
+  }
+
+  // Unknown ids and failed loads are not kept, so a commitment published later is picked up
+  auto forget = [&]() {
+    lock_guard<mutex> guard(lock);
+    auto found = index.find(commitmentId);
+    if (found == index.end() || found->second->second.wait_for(chrono::seconds(0)) != future_status::ready) {
+      return;
+    }
+    bool failed = false;
+    try {
+      failed = !found->second->second.get();
+    } catch (...) {
+      failed = true;
+    }
+    if (failed) {
+      recent.erase(found->second);
+      index.erase(found);
+    }
+  };
+  Key key;
+  try {
+    key = loader(commitmentId);
+  } catch (...) {
+    loaded.set_exception(current_exception());
+    forget();
+    throw;
+  }
+  loaded.set_value(key);
+  if (!key) {
+    forget();
+    return key;
+  }
+  // Evict only once the new entry is known to be worth keeping
+  lock_guard<mutex> guard(lock);
+  while (recent.size() > capacity) {
+    index.erase(recent.back().first);
+    recent.pop_back();
+  }
+  return key;
+}
+
+size_t CommitmentCache::size() {
+  lock_guard<mutex> guard(lock);
+  return recent.size();
+}
+
+// Function to get the verifying key of a commitment by id, from data/commitments or data/program_commitment.json
+CommitmentCache::Key loadCommitmentById(const string& commitmentId) {
+  // The id becomes part of a path
+  if (commitmentId.empty() || commitmentId.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
+    return nullptr;
+  }
+  nlohmann::json commitmentJsonData;
+  std::ifstream commitmentFileStream("data/commitments/" + commitmentId + ".json");
+  if (commitmentFileStream.is_open()) {
+    commitmentFileStream >> commitmentJsonData;
+  } else {
+    std::ifstream programCommitment("data/program_commitment.json");
+    if (!programCommitment.is_open()) {
+      return nullptr;
+    }
+    programCommitment >> commitmentJsonData;
+  }
+  if (commitmentJsonData.value("commitmentId", "") != commitmentId) {
+    return nullptr;
+  }
+
+  std::ifstream classFileStream("class.json");
+  if (!classFileStream.is_open()) {
+    throw std::runtime_error("Error: Fides cannot open class.json");
+  }
+  nlohmann::json classJsonData;
+  classFileStream >> classJsonData;
+  return make_shared<const VerifyingKey>(cachedVerifyingKey(commitmentJsonData, classJsonData));
+}
+/*******************************  CommitmentCache  ******************************/
+
+
+/*******************************  LatencyHistogram  *****************************/
+void LatencyHistogram::record(chrono::steady_clock::duration latency) {
+  uint64_t microseconds = uint64_t(max<int64_t>(0, chrono::duration_cast<chrono::microseconds>(latency).count()));
+  int bucket = microseconds == 0 ? 0 : min(bucketCount - 1, 64 - __builtin_clzll(microseconds));
+  buckets[bucket]++;
+  total++;
+  uint64_t seen = maxMicroseconds;
+  while (microseconds > seen && !maxMicroseconds.compare_exchange_weak(seen, microseconds)) {
+  }
+}
+
+// Function to get the upper bound of the bucket holding quantile q
+uint64_t LatencyHistogram::quantile(double q) const {
+  uint64_t count = total;
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t rank = max<uint64_t>(1, uint64_t(ceil(q * count)));
+  uint64_t seen = 0;
+  for (int i = 0; i < bucketCount; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return uint64_t(1) << i;
+    }
+  }
+  return maxMicroseconds;
+}
+
+string LatencyHistogram::summary() const {
+  ostringstream line;
+  line << total << " samples, p50 < " << quantile(0.5) << " us, p90 < " << quantile(0.9)
+       << " us, p99 < " << quantile(0.99) << " us, max " << maxMicroseconds << " us";
+  return line.str();
+}
+/*******************************  LatencyHistogram  *****************************/
+
+
+string Verdict::toJson() const {
+  ordered_json verdict;
+  verdict["commitmentId"] = commitmentId;
+  verdict["deviceId"] = deviceId;
+  verdict["verified"] = verified;
+  verdict["latency_us"] = latencyMicroseconds;
+  if (!error.empty()) {
+    verdict["error"] = error;
+  }
+  return verdict.dump();
+}
+
+
+/*******************************  VerifierService  ******************************/
+VerifierService::VerifierService(CommitmentCache& cache, size_t workerCount, size_t capacity)
+  : cache(cache), capacity(capacity == 0 ? 1 : capacity) {
+  if (workerCount == 0) {
+    workerCount = max(1u, thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < workerCount; i++) {
+    workers.emplace_back(&VerifierService::worker, this);
+  }
+}
+
+VerifierService::~VerifierService() {
+  stop();
+}
+
+// Function to queue a payload for the workers
+bool VerifierService::submit(string payload, PayloadFormat format, Reply reply, bool wait) {
+  {
+    unique_lock<mutex> guard(lock);
+    if (wait) {
+      spaceLeft.wait(guard, [&]() { return stopping || queue.size() < capacity; });
+    }
+    if (stopping || queue.size() >= capacity) {
+      rejectedCount++;
+      return false;
+    }
+    queue.push_back(Job{ std::move(payload), format, std::move(reply), Clock::now() });
+  }
+  wakeUp.notify_one();
+  return true;
+}
+
+size_t VerifierService::pending() {
+  lock_guard<mutex> guard(lock);
+  return queue.size();
+}
+
+// Function to finish the queued payloads and join the workers
+void VerifierService::stop() {
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  spaceLeft.notify_all();
+  for (thread& worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void VerifierService::worker() {
+  while (true) {
+    Job job;
+    {
+      unique_lock<mutex> guard(lock);
+      wakeUp.wait(guard, [&]() { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      job = std::move(queue.front());
+      queue.pop_front();
+    }
+    spaceLeft.notify_one();
+
+    Clock::time_point started = Clock::now();
+    queueLatency.record(started - job.queuedAt);
+    Verdict verdict = verify(job);
+    Clock::time_point done = Clock::now();
+    verifyLatency.record(done - started);
+    totalLatency.record(done - job.queuedAt);
+    verdict.latencyMicroseconds = uint64_t(chrono::duration_cast<chrono::microseconds>(done - job.queuedAt).count());
+    if (verdict.verified) {
+      verifiedCount++;
+    } else {
+      failedCount++;
+    }
+
+    if (job.reply) {
+      try {
+        job.reply(verdict);
+      } catch (const exception& e) {
+        cerr << "Verdict for " << verdict.commitmentId << " could not be delivered: " << e.what() << endl;
+      }
+    }
+  }
+}
+
+// Function to verify one payload; errors become a failed verdict
+Verdict VerifierService::verify(const Job& job) {
+  Verdict verdict;
+  try {
+    ordered_json doc = decodeTelemetry(job.payload, job.format);
+    if (doc.contains("from") && doc["from"].is_string()) {
+      verdict.deviceId = doc["from"].get<string>();
+    }
+    const ordered_json& proof = doc.contains("data") && doc["data"].contains("proof") ? doc["data"]["proof"] : doc;
+    if (!proof.contains("commitmentId")) {
+      verdict.error = "no commitmentId";
+      return verdict;
+    }
+    verdict.commitmentId = proof["commitmentId"].get<string>();
+    CommitmentCache::Key key = cache.get(verdict.commitmentId);
+    if (!key) {
+      verdict.error = "unknown commitment";
+      return verdict;
+    }
+    verdict.verified = evaluateProof(*key, proof).holds();
+  } catch (const exception& e) {
+    verdict.verified = false;
+    verdict.error = e.what();
+  }
+  return verdict;
+}
+/*******************************  VerifierService  ******************************/
+
+
+/*******************************  UnixSocketInput  ******************************/
+struct UnixSocketInput::Connection {
+  int fd;
+  mutex writeLock;
+
+  explicit Connection(int fd) : fd(fd) {}
+  ~Connection() { close(fd); }
+
+  // Function to write a whole line; a client that went away is ignored
+  void send(const string& line) {
+    lock_guard<mutex> guard(writeLock);
+    size_t sent = 0;
+    while (sent < line.size()) {
+      ssize_t written = ::send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+      if (written <= 0) {
+        return;
+      }
+      sent += size_t(written);
+    }
+  }
+};
+
+// Function to read exactly size bytes; false on end of stream or error
+static bool readFully(int fd, char* buffer, size_t size) {
+  size_t received = 0;
+  while (received < size) {
+    ssize_t count = read(fd, buffer + received, size - received);
+    if (count <= 0) {
+      return false;
+    }
+    received += size_t(count);
+  }
+  return true;
+}
+
+UnixSocketInput::UnixSocketInput(VerifierService& service, PayloadFormat format)
+  : service(service), format(format) {}
+
+UnixSocketInput::~UnixSocketInput() {
+  stop();
+}
+
+// Function to bind the socket and start the accept thread
+bool UnixSocketInput::start(const string& socketPath) {
+  struct sockaddr_un address = {};
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    cerr << "Socket path too long: " << socketPath << endl;
+    return false;
+  }
+  address.sun_family = AF_UNIX;
+  socketPath.copy(address.sun_path, socketPath.size());
+
+  listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    perror("socket");
+    return false;
+  }
+  unlink(socketPath.c_str());
+  if (::bind(listenFd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, 64) < 0) {
+    perror("bind");
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  path = socketPath;
+  running = true;
+  acceptThread = thread(&UnixSocketInput::acceptLoop, this);
+  return true;
+}
+
+// Function to stop accepting, end the readers and remove the socket
+void UnixSocketInput::stop() {
+  if (!running.exchange(false)) {
+    return;
+  }
+  // Unblocks accept()
+  shutdown(listenFd, SHUT_RDWR);
+  acceptThread.join();
+  close(listenFd);
+  listenFd = -1;
+
+  unique_lock<mutex> guard(lock);
+  for (const weak_ptr<Connection>& weak : connections) {
+    if (shared_ptr<Connection> connection = weak.lock()) {
+      // Ends the reader; verdicts still queued are written before the socket closes
+      shutdown(connection->fd, SHUT_RD);
+    }
+  }
+  readersDone.wait(guard, [&]() { return activeReaders == 0; });
+  connections.clear();
+  unlink(path.c_str());
+}
+
+void UnixSocketInput::acceptLoop() {
+  while (running) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      if (running && errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    auto connection = make_shared<Connection>(fd);
+    {
+      lock_guard<mutex> guard(lock);
+      connections.erase(remove_if(connections.begin(), connections.end(), [](const weak_ptr<Connection>& weak) { return weak.expired(); }),
+                        connections.end());
+      connections.push_back(connection);
+      activeReaders++;
+    }
+    thread(&UnixSocketInput::serve, this, connection).detach();
+  }
+}
+
+// Function to read the frames of one client and queue them
+void UnixSocketInput::serve(shared_ptr<Connection> connection) {
+  const uint32_t maxFrame = 16 << 20;
+  while (true) {
+    unsigned char header[4];
+    if (!readFully(connection->fd, (char*)header, sizeof(header))) {
+      break;
+    }
+    uint32_t length = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) | (uint32_t(header[2]) << 8) | header[3];
+    if (length > maxFrame) {
+      Verdict verdict;
+      verdict.error = "frame too large";
+      connection->send(verdict.toJson() + "\n");
+      break;
+    }
+    string payload(length, '\0');
+    if (!readFully(connection->fd, &payload[0], length)) {
+      break;
+    }
+    // Blocking here pushes back on the client when the workers fall behind
+    if (!service.submit(std::move(payload), format, [connection](const Verdict& verdict) { connection->send(verdict.toJson() + "\n"); }, true)) {
+      break;
+    }
+  }
+  connection.reset();
+  lock_guard<mutex> guard(lock);
+  activeReaders--;
+  readersDone.notify_all();
+}
+/*******************************  UnixSocketInput  ******************************/
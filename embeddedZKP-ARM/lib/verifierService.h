@@ -0,0 +1,184 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIFIER_SERVICE_H
+#define VERIFIER_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "proofVerifier.h"
+#include "proofEnvelope.h"
+
+using namespace std;
+
+// LRU cache of verifying keys keyed by commitmentId. A miss calls the
+// loader once per id even when several workers ask for it at the same time;
+// the others wait for that load.
+class CommitmentCache {
+public:
+  using Key = shared_ptr<const VerifyingKey>;
+  using Loader = function<Key(const string& commitmentId)>;
+
+  CommitmentCache(size_t capacity, Loader loader);
+
+  // Function to get the verifying key of a commitment; nullptr when the loader has none
+  Key get(const string& commitmentId);
+
+  uint64_t hits() const { return hitCount; }
+  uint64_t misses() const { return missCount; }
+  size_t size();
+
+private:
+  using Entry = pair<string, shared_future<Key>>;
+
+  size_t capacity;
+  Loader loader;
+  mutex lock;
+  list<Entry> recent;   // most recently used first
+  unordered_map<string, list<Entry>::iterator> index;
+  atomic<uint64_t> hitCount{ 0 };
+  atomic<uint64_t> missCount{ 0 };
+};
+
+// Function to get the verifying key of data/commitments/<commitmentId>.json,
+// or of data/program_commitment.json when it carries that id
+CommitmentCache::Key loadCommitmentById(const string& commitmentId);
+
+// Latency histogram with power-of-two buckets in microseconds; bucket i
+// counts samples in [2^(i-1), 2^i). Safe to record from any thread.
+class LatencyHistogram {
+public:
+  static const int bucketCount = 32;
+
+  void record(chrono::steady_clock::duration latency);
+
+  uint64_t count() const { return total; }
+
+  // Function to get the upper bound in microseconds of the bucket holding quantile q
+  uint64_t quantile(double q) const;
+
+  // Function to format the count, p50/p90/p99 and the maximum in one line
+  string summary() const;
+
+private:
+  atomic<uint64_t> buckets[bucketCount] = {};
+  atomic<uint64_t> total{ 0 };
+  atomic<uint64_t> maxMicroseconds{ 0 };
+};
+
+struct Verdict {
+  string commitmentId;
+  string deviceId;
+  bool verified = false;
+  string error;                  // why the proof could not be checked
+  uint64_t latencyMicroseconds = 0;
+
+  string toJson() const;
+};
+
+// Pool of verifier workers behind a bounded queue of telemetry payloads.
+// A payload is a proof, or an MQTT telemetry document with the proof in data.proof.
+class VerifierService {
+public:
+  using Reply = function<void(const Verdict&)>;
+
+  VerifierService(CommitmentCache& cache, size_t workers, size_t capacity);
+  ~VerifierService();
+
+  // Function to queue a payload. With wait the caller blocks while the queue
+  // is full, otherwise the payload is refused and false is returned.
+  bool submit(string payload, PayloadFormat format, Reply reply, bool wait);
+
+  // Function to finish the queued payloads and join the workers
+  void stop();
+
+  uint64_t rejected() const { return rejectedCount; }
+  size_t pending();
+
+  LatencyHistogram queueLatency;    // submit to the start of verification
+  LatencyHistogram verifyLatency;   // verification alone
+  LatencyHistogram totalLatency;    // submit to verdict
+  atomic<uint64_t> verifiedCount{ 0 };
+  atomic<uint64_t> failedCount{ 0 };
+
+private:
+  using Clock = chrono::steady_clock;
+
+  struct Job {
+    string payload;
+    PayloadFormat format;
+    Reply reply;
+    Clock::time_point queuedAt;
+  };
+
+  void worker();
+  Verdict verify(const Job& job);
+
+  CommitmentCache& cache;
+  size_t capacity;
+  mutex lock;
+  condition_variable wakeUp;
+  condition_variable spaceLeft;
+  deque<Job> queue;
+  bool stopping = false;
+  atomic<uint64_t> rejectedCount{ 0 };
+  vector<thread> workers;
+};
+
+// Unix stream socket in front of a VerifierService. A client sends frames of
+// a 4-byte big-endian length followed by the payload and reads back one
+// verdict per frame as a line of JSON, in completion order.
+class UnixSocketInput {
+public:
+  UnixSocketInput(VerifierService& service, PayloadFormat format);
+  ~UnixSocketInput();
+
+  // Function to bind the socket (replacing a stale one) and start accepting
+  bool start(const string& path);
+
+  // Function to stop accepting and close every connection
+  void stop();
+
+private:
+  struct Connection;
+
+  void acceptLoop();
+  void serve(shared_ptr<Connection> connection);
+
+  VerifierService& service;
+  PayloadFormat format;
+  string path;
+  int listenFd = -1;
+  atomic<bool> running{ false };
+  thread acceptThread;
+  mutex lock;
+  condition_variable readersDone;
+  vector<weak_ptr<Connection>> connections;
+  size_t activeReaders = 0;
+};
+
+#endif  // VERIFIER_SERVICE_H
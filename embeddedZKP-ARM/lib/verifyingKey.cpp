@@ -0,0 +1,216 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verifyingKey.h"
+#include "polynomial.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+
+// Function to multiply in F_p without overflowing for primes above 2^32
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p) {
+  return uint64_t((unsigned __int128)a * b % p);
+}
+
+uint64_t VerifyingKey::vH(uint64_t x) const {
+  return Polynomial::subtractModP(Polynomial::power(x, n, p), 1, p);
+}
+
+uint64_t VerifyingKey::vK(uint64_t x) const {
+  return Polynomial::subtractModP(Polynomial::power(x, m, p), 1, p);
+}
+
+// Function to evaluate x_hat at x from its values on zero_to_t_for_H:
+// x_hat(x) = v_H(x) * sum_i values[i] * xHatWeights[i] / (x - h_i)
+uint64_t VerifyingKey::interpolate(const vector<uint64_t>& values, uint64_t x) const {
+  x %= p;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < zero_to_t_for_H.size(); i++) {
+    uint64_t difference = Polynomial::subtractModP(x, zero_to_t_for_H[i], p);
+    if (difference == 0) {
+      return values[i] % p;
+    }
+    uint64_t term = mulMod(values[i] % p, xHatWeights[i], p);
+    sum = (sum + mulMod(term, Polynomial::pInverse(difference, p), p)) % p;
+  }
+  return mulMod(Polynomial::evaluatePolynomial(v_H, x, p), sum, p);
+}
+
+string verifyingKeySource(const nlohmann::json& commitment, const nlohmann::json& classes, uint64_t vk) {
+  string class_value = to_string(commitment["class"].get<uint64_t>());
+  string text = commitment.dump() + "|" + classes[class_value].dump() + "|" + to_string(vk);
+  return Polynomial::SHA256(&text[0]);
+}
+
+VerifyingKey prepareVerifyingKey(const nlohmann::json& commitment, const nlohmann::json& classes, uint64_t vk) {
+  VerifyingKey key;
+  if (commitment.contains("commitmentId")) {
+    key.commitmentId = commitment["commitmentId"].get<string>();
+  }
+  key.Class = commitment["class"].get<uint64_t>();
+  key.rowA_x = commitment["row_AHP_A"].get<vector<uint64_t>>();
+  key.colA_x = commitment["col_AHP_A"].get<vector<uint64_t>>();
+  key.valA_x = commitment["val_AHP_A"].get<vector<uint64_t>>();
+  key.rowB_x = commitment["row_AHP_B"].get<vector<uint64_t>>();
+  key.colB_x = commitment["col_AHP_B"].get<vector<uint64_t>>();
+  key.valB_x = commitment["val_AHP_B"].get<vector<uint64_t>>();
+  key.rowC_x = commitment["row_AHP_C"].get<vector<uint64_t>>();
+  key.colC_x = commitment["col_AHP_C"].get<vector<uint64_t>>();
+  key.valC_x = commitment["val_AHP_C"].get<vector<uint64_t>>();
+
+  string class_value = to_string(key.Class);
+  if (!classes.contains(class_value)) {
+    throw std::runtime_error("Error: Fides class " + class_value + " of the commitment is not in class.json");
+  }
+  key.n_g = classes[class_value]["n_g"].get<uint64_t>();
+  key.n_i = classes[class_value]["n_i"].get<uint64_t>();
+  key.n   = classes[class_value]["n"].get<uint64_t>();
+  key.m   = classes[class_value]["m"].get<uint64_t>();
+  key.p   = classes[class_value]["p"].get<uint64_t>();
+  key.g   = classes[class_value]["g"].get<uint64_t>();
+  uint64_t n = key.n, m = key.m, p = key.p, g = key.g;
+  key.vk = vk;
+  key.source = verifyingKeySource(commitment, classes, key.vk);
+
+  key.omegaK = Polynomial::power(g, mulMod(p - 1, Polynomial::pInverse(m, p), p), p);
+  key.omegaH = Polynomial::power(g, ((p - 1) / n) % p, p);
+
+  uint64_t t = key.n_i + 1;
+  uint64_t h = 1;
+  for (uint64_t i = 0; i < t; i++) {
+    key.zero_to_t_for_H.push_back(h);
+    h = mulMod(h, key.omegaH, p);
+  }
+  key.v_H = Polynomial::expandPolynomials(key.zero_to_t_for_H, p);
+  for (uint64_t i = 0; i < t; i++) {
+    uint64_t product = 1;
+    for (uint64_t j = 0; j < t; j++) {
+      if (j != i) {
+        product = mulMod(product, Polynomial::subtractModP(key.zero_to_t_for_H[i], key.zero_to_t_for_H[j], p), p);
+      }
+    }
+    key.xHatWeights.push_back(Polynomial::pInverse(product, p));
+  }
+
+  key.nInverse = Polynomial::pInverse(n, p);
+  key.mInverse = Polynomial::pInverse(m, p);
+  return key;
+}
+
+bool writeVerifyingKey(const string& path, const VerifyingKey& key) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  uint32_t idLength = uint32_t(key.commitmentId.size());
+  uint64_t scalars[] = { key.Class, key.n_i, key.n_g, key.n, key.m, key.p, key.g, key.vk,
+                         key.omegaH, key.omegaK, key.nInverse, key.mInverse };
+  const vector<uint64_t>* polynomials[] = { &key.rowA_x, &key.colA_x, &key.valA_x, &key.rowB_x, &key.colB_x, &key.valB_x,
+                                            &key.rowC_x, &key.colC_x, &key.valC_x, &key.zero_to_t_for_H, &key.xHatWeights, &key.v_H };
+  bool written = fwrite(verifyingKeyMagic, sizeof(verifyingKeyMagic), 1, file) == 1 &&
+                 fwrite(&verifyingKeyVersion, sizeof(verifyingKeyVersion), 1, file) == 1 &&
+                 key.source.size() == 64 && fwrite(key.source.data(), 1, 64, file) == 64 &&
+                 fwrite(&idLength, sizeof(idLength), 1, file) == 1 &&
+                 fwrite(key.commitmentId.data(), 1, idLength, file) == idLength &&
+                 fwrite(scalars, sizeof(scalars), 1, file) == 1;
+  for (const vector<uint64_t>* polynomial : polynomials) {
+    uint64_t size = polynomial->size();
+    written = written && fwrite(&size, sizeof(size), 1, file) == 1 &&
+              fwrite(polynomial->data(), sizeof(uint64_t), size, file) == size;
+  }
+  return fclose(file) == 0 && written;
+}
+
+bool readVerifyingKey(const string& path, VerifyingKey& key) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  uint64_t fileSize = uint64_t(ftell(file));
+  rewind(file);
+  char magic[8];
+  uint32_t version = 0, idLength = 0;
+  char source[64];
+  bool valid = fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, verifyingKeyMagic, sizeof(magic)) == 0 &&
+               fread(&version, sizeof(version), 1, file) == 1 && version == verifyingKeyVersion &&
+               fread(source, sizeof(source), 1, file) == 1 &&
+               fread(&idLength, sizeof(idLength), 1, file) == 1 && idLength < 4096;
+  if (valid) {
+    key.source.assign(source, sizeof(source));
+    key.commitmentId.assign(idLength, '\0');
+    valid = fread(&key.commitmentId[0], 1, idLength, file) == idLength;
+  }
+  uint64_t scalars[12];
+  valid = valid && fread(scalars, sizeof(scalars), 1, file) == 1;
+  if (valid) {
+    uint64_t* fields[] = { &key.Class, &key.n_i, &key.n_g, &key.n, &key.m, &key.p, &key.g, &key.vk,
+                           &key.omegaH, &key.omegaK, &key.nInverse, &key.mInverse };
+    for (size_t i = 0; i < 12; i++) {
+      *fields[i] = scalars[i];
+    }
+  }
+  vector<uint64_t>* polynomials[] = { &key.rowA_x, &key.colA_x, &key.valA_x, &key.rowB_x, &key.colB_x, &key.valB_x,
+                                      &key.rowC_x, &key.colC_x, &key.valC_x, &key.zero_to_t_for_H, &key.xHatWeights, &key.v_H };
+  for (vector<uint64_t>* polynomial : polynomials) {
+    uint64_t size = 0;
+    valid = valid && fread(&size, sizeof(size), 1, file) == 1 && size <= fileSize / sizeof(uint64_t);
+    if (valid) {
+      polynomial->resize(size);
+      valid = fread(polynomial->data(), sizeof(uint64_t), size, file) == size;
+    }
+  }
+  // Nothing may follow the last polynomial
+  valid = valid && fgetc(file) == EOF;
+  // interpolate indexes the x_hat points, weights and v_H together
+  valid = valid && key.zero_to_t_for_H.size() == key.n_i + 1 && key.xHatWeights.size() == key.zero_to_t_for_H.size() &&
+          key.v_H.size() == key.zero_to_t_for_H.size() + 1;
+  fclose(file);
+  return valid;
+}
+
+VerifyingKey cachedVerifyingKey(const nlohmann::json& commitment, const nlohmann::json& classes) {
+  uint64_t Class = commitment["class"].get<uint64_t>();
+  string class_value = to_string(Class);
+  if (!classes.contains(class_value)) {
+    throw std::runtime_error("Error: Fides class " + class_value + " of the commitment is not in class.json");
+  }
+  // Only the vk of the setup goes into the key, so ck is never loaded: the
+  // cache is keyed on that vk and the hash of the commitment and its class
+  uint64_t vk = loadSetupVk(Class, classes[class_value]["p"].get<uint64_t>(), classes[class_value]["g"].get<uint64_t>(),
+                            ahpDegree(classes[class_value]["n_g"].get<uint64_t>(), classes[class_value]["n_i"].get<uint64_t>()));
+  string source = verifyingKeySource(commitment, classes, vk);
+  string path = string(verifyingKeyDirectory) + "/" + source + ".bin";
+
+  VerifyingKey key;
+  if (readVerifyingKey(path, key) && key.source == source) {
+    return key;
+  }
+  key = prepareVerifyingKey(commitment, classes, vk);
+  std::error_code error;
+  std::filesystem::create_directories(verifyingKeyDirectory, error);
+  // Another verifier may be writing the same key; the rename keeps readers from seeing half a file
+  string temporary = path + "." + to_string(getpid()) + "." + to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+  if (!writeVerifyingKey(temporary, key) || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    cerr << "Warning: cannot store the verifying key in " << path << endl;
+  }
+  return key;
+}
@@ -0,0 +1,90 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef VERIFYING_KEY_H
+#define VERIFYING_KEY_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "json.hpp"
+#include "srs.h"
+
+using namespace std;
+
+// Verifying key file, data/vk/<source>.bin, where source is the SHA-256 of
+// the commitment, its class parameters and vk, so a changed commitment or
+// setup never reads a stale key. Host byte order:
+//   char magic[8], uint32_t version, char source[64], uint32_t idLength, char commitmentId[idLength],
+//   uint64_t Class, n_i, n_g, n, m, p, g, vk, omegaH, omegaK, nInverse, mInverse,
+//   then each polynomial as uint64_t size, uint64_t coefficients[size]
+const char verifyingKeyMagic[8] = { 'F', 'I', 'D', 'E', 'S', 'V', 'K', '\0' };
+const uint32_t verifyingKeyVersion = 1;
+const char verifyingKeyDirectory[] = "data/vk";
+
+// Everything the verifier derives from the commitment, its class and the
+// setup. It does not depend on a proof, so one key serves every proof
+// checked against the same commitment.
+//
+// H and K are the subgroups generated by omegaH and omegaK, so their
+// vanishing polynomials vH(x) = x^n - 1 and vK(x) = x^m - 1 are kept in that
+// form. x_hat is interpolated over the first t = n_i + 1 points of H; the
+// barycentric weights xHatWeights[i] = 1 / prod_{j != i}(h_i - h_j) let a
+// proof evaluate it at one point in O(t).
+struct VerifyingKey {
+  string source;
+  string commitmentId;
+  uint64_t Class = 0;
+  uint64_t n_i = 0, n_g = 0, n = 0, m = 0, p = 0, g = 0;
+  uint64_t vk = 0;
+  uint64_t omegaH = 0, omegaK = 0;
+  uint64_t nInverse = 0, mInverse = 0;
+
+  vector<uint64_t> rowA_x, colA_x, valA_x;
+  vector<uint64_t> rowB_x, colB_x, valB_x;
+  vector<uint64_t> rowC_x, colC_x, valC_x;
+
+  vector<uint64_t> zero_to_t_for_H;   // the first t points of H
+  vector<uint64_t> xHatWeights;
+  vector<uint64_t> v_H;               // vanishing polynomial of zero_to_t_for_H
+
+  // Function to evaluate vH(x) = x^n - 1
+  uint64_t vH(uint64_t x) const;
+
+  // Function to evaluate vK(x) = x^m - 1
+  uint64_t vK(uint64_t x) const;
+
+  // Function to evaluate the polynomial through (zero_to_t_for_H[i], values[i]) at x
+  uint64_t interpolate(const vector<uint64_t>& values, uint64_t x) const;
+};
+
+// Function to hash what the verifying key of a commitment is derived from
+string verifyingKeySource(const nlohmann::json& commitment, const nlohmann::json& classes, uint64_t vk);
+
+// Function to derive the verifying key of a commitment; classes is class.json
+// and vk the one of the class's setup
+VerifyingKey prepareVerifyingKey(const nlohmann::json& commitment, const nlohmann::json& classes, uint64_t vk);
+
+bool writeVerifyingKey(const string& path, const VerifyingKey& key);
+
+// Function to read a verifying key; false if the file is missing or malformed,
+// or its x_hat points, weights and v_H do not match n_i
+bool readVerifyingKey(const string& path, VerifyingKey& key);
+
+// Function to read the verifying key of a commitment from data/vk, preparing
+// and storing it there when it is missing
+VerifyingKey cachedVerifyingKey(const nlohmann::json& commitment, const nlohmann::json& classes);
+
+#endif  // VERIFYING_KEY_H
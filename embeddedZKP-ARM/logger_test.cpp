@@ -0,0 +1,85 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the log levels and the binary debug dump.
+// `g++ -std=c++17 logger_test.cpp lib/polynomial.cpp -o logger_test`
+
+#include "lib/polynomial.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+const char* path = "logger_test.bin";
+
+void test_levels() {
+    assert(parseLogLevel("trace", LogLevel::Info) == LogLevel::Trace);
+    assert(parseLogLevel("2", LogLevel::Info) == LogLevel::Warning);
+    assert(parseLogLevel("loud", LogLevel::Info) == LogLevel::Info);
+    assert(parseLogLevel(nullptr, LogLevel::Error) == LogLevel::Error);
+
+    setLogLevel(LogLevel::Warning);
+    assert(logEnabled(LogLevel::Error) && logEnabled(LogLevel::Warning));
+    assert(!logEnabled(LogLevel::Info) && !logEnabled(LogLevel::Trace));
+
+    // A disabled statement does not evaluate its message
+    int evaluated = 0;
+    FIDES_LOG(LogLevel::Debug, "value " << ++evaluated);
+    assert(evaluated == 0);
+    FIDES_LOG(LogLevel::Error, "logger_test: this line is expected " << ++evaluated);
+    assert(evaluated == 1);
+    std::cout << "levels: ok\n";
+}
+
+void test_debug_dump() {
+    // Nothing reaches the terminal at the Warning level; both go to the dump
+    Polynomial::printPolynomial({ 5, 0, 7 }, "f(x)");
+    // A ragged matrix is refused, not truncated or padded
+    vector<vector<uint64_t>> ragged = { { 1, 2 }, { 3, 4, 5 } };
+    Polynomial::printMatrix(ragged, "R");
+    vector<vector<uint64_t>> matrix = { { 1, 2, 3 }, { 4, 5, 6 } };
+    Polynomial::printMatrix(matrix, "M");
+
+    FILE* file = fopen(path, "rb");
+    assert(file);
+    auto readRecord = [&](string& name, uint64_t& rows, uint64_t& columns, vector<uint64_t>& values) {
+        uint32_t length = 0;
+        bool read = fread(&length, sizeof(length), 1, file) == 1;
+        name.assign(length, '\0');
+        read = read && fread(&name[0], 1, length, file) == length;
+        read = read && fread(&rows, sizeof(rows), 1, file) == 1;
+        read = read && fread(&columns, sizeof(columns), 1, file) == 1;
+        values.resize(read ? rows * columns : 0);
+        read = read && fread(values.data(), sizeof(uint64_t), values.size(), file) == values.size();
+        assert(read);
+    };
+    string name;
+    uint64_t rows, columns;
+    vector<uint64_t> values;
+    readRecord(name, rows, columns, values);
+    assert(name == "f(x)" && rows == 1 && columns == 3 && values == vector<uint64_t>({ 5, 0, 7 }));
+    readRecord(name, rows, columns, values);
+    assert(name == "M" && rows == 2 && columns == 3 && values == vector<uint64_t>({ 1, 2, 3, 4, 5, 6 }));
+    assert(fgetc(file) == EOF);
+    fclose(file);
+    std::remove(path);
+    std::cout << "debug dump: ok\n";
+}
+
+int main() {
+    setenv("FIDES_DEBUG_DUMP", path, 1);
+    test_levels();
+    test_debug_dump();
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs MqttPublisher against a local broker (`mosquitto -p 1883`).
+// `g++ -std=c++17 mqttPublisher_test.cpp lib/mqttPublisher.cpp -o mqttPublisher_test -lmosquitto -lpthread`
+
+#include "lib/mqttPublisher.h"
+#include <iostream>
+#include <string>
+#include <cassert>
+
+void on_connect(struct mosquitto *mosq, void *obj, int rc) {
+    static_cast<MqttPublisher *>(obj)->connected(rc == 0);
+}
+void on_publish(struct mosquitto *mosq, void *obj, int mid) {
+    static_cast<MqttPublisher *>(obj)->published(mid);
+}
+void on_disconnect(struct mosquitto *mosq, void *obj, int rc) {
+    static_cast<MqttPublisher *>(obj)->connected(false);
+}
+
+struct Client {
+    struct mosquitto *mosq;
+    MqttPublisher publisher;
+
+    Client(size_t capacity, int qos) : mosq(mosquitto_new(nullptr, true, nullptr)), publisher(mosq, capacity, 8, qos) {
+        assert(mosq);
+        mosquitto_user_data_set(mosq, &publisher);
+        mosquitto_connect_callback_set(mosq, on_connect);
+        mosquitto_publish_callback_set(mosq, on_publish);
+        mosquitto_disconnect_callback_set(mosq, on_disconnect);
+    }
+    ~Client() {
+        publisher.stop();
+        mosquitto_destroy(mosq);
+    }
+};
+
+void test_backpressure_before_connect() {
+    Client client(4, 0);
+    for (int i = 0; i < 4; i++) {
+        bool queued = client.publisher.publish("fides/test", "queued " + std::to_string(i));
+        assert(queued);
+    }
+    bool queued = client.publisher.publish("fides/test", "one too many");
+    assert(!queued);
+    assert(client.publisher.metrics().rejected == 1);
+
+    // Everything held while offline goes out once the broker accepts us
+    int rc = mosquitto_connect(client.mosq, "localhost", 1883, 15);
+    assert(rc == MOSQ_ERR_SUCCESS);
+    bool started = client.publisher.start();
+    assert(started);
+    bool flushed = client.publisher.flush(5000);
+    assert(flushed);
+    MqttPublisher::Metrics m = client.publisher.metrics();
+    assert(m.published == 4 && m.queueDepth == 0 && m.maxQueueDepth == 4);
+    std::cout << "backpressure before connect: ok\n";
+}
+
+void test_batched_throughput(int qos) {
+    Client client(64, qos);
+    int rc = mosquitto_connect(client.mosq, "localhost", 1883, 15);
+    assert(rc == MOSQ_ERR_SUCCESS);
+    bool started = client.publisher.start();
+    assert(started);
+
+    const int messages = 1000;
+    std::string payload(2048, 'p');
+    int accepted = 0;
+    while (accepted < messages) {
+        if (client.publisher.publish("fides/test", payload)) {
+            accepted++;
+        } else {
+            client.publisher.flush(100);
+        }
+    }
+    bool flushed = client.publisher.flush(10000);
+    assert(flushed);
+    MqttPublisher::Metrics m = client.publisher.metrics();
+    assert(m.published == messages && m.failed == 0);
+    std::cout << "qos " << qos << ": " << m.published << " published, " << m.rejected << " rejected, max depth "
+              << m.maxQueueDepth << ", latency avg " << m.averageLatencyMs << " ms, max " << m.maxLatencyMs << " ms\n";
+}
+
+int main() {
+    mosquitto_lib_init();
+    test_backpressure_before_connect();
+    test_batched_throughput(0);
+    test_batched_throughput(1);
+    mosquitto_lib_cleanup();
+    std::cout << "All MQTT publisher tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares telemetry payload size and encode time for each wire format, using
+// the proof in data/proof.json. Pass a directory to also save one payload per
+// format there, e.g. for `./verifier <dir>/payload.cbor`.
+// `g++ -std=c++17 -O2 payloadBenchmark.cpp lib/proofEnvelope.cpp -o payloadBenchmark`
+
+#include "lib/proofEnvelope.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cassert>
+
+using namespace std::chrono;
+
+int main(int argc, char* argv[]) {
+    std::ifstream proofFile("data/proof.json");
+    if (!proofFile.is_open()) {
+        std::cerr << "Could not open data/proof.json" << std::endl;
+        return 1;
+    }
+    ordered_json proof;
+    proofFile >> proof;
+
+    ordered_json doc;
+    doc["from"] = "MDA6MUI6MUI6QUE6QkI6Q0M=";
+    doc["to"] = "panel.example.io";
+    doc["data"]["Framware Version"] = "1.7";
+    doc["data"]["Hardware Version"] = "1";
+    doc["data"]["Root"] = true;
+    doc["data"]["Temperature"] = "23.5 (°C)";
+    doc["data"]["Humidity"] = "15.0 (%)";
+    doc["data"]["Button"] = "Pressed";
+    doc["data"]["proof"] = proof;
+
+    const int rounds = 2000;
+    const std::pair<const char*, PayloadFormat> formats[] = {
+        {"json", PayloadFormat::Json},
+        {"cbor", PayloadFormat::Cbor},
+        {"msgpack", PayloadFormat::MsgPack}
+    };
+
+    std::cout << "format    bytes   encode(us)  decode(us)" << std::endl;
+    for (const auto& format : formats) {
+        std::string payload;
+        auto start = steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            payload = encodeTelemetry(doc, format.second);
+        }
+        double encodeUs = duration<double, std::micro>(steady_clock::now() - start).count() / rounds;
+
+        ordered_json decoded;
+        start = steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            decoded = decodeTelemetry(payload, format.second);
+        }
+        double decodeUs = duration<double, std::micro>(steady_clock::now() - start).count() / rounds;
+        assert(decoded == doc);
+
+        printf("%-8s %6zu %12.1f %11.1f\n", format.first, payload.size(), encodeUs, decodeUs);
+        if (argc > 1) {
+            std::ofstream out(std::string(argv[1]) + "/payload." + format.first, std::ios::binary);
+            out << payload;
+        }
+    }
+
+    // Compact JSON for reference: the saving that needs no decoder change at all
+    std::cout << "json without indentation: " << doc.dump().size() << " bytes" << std::endl;
+    return 0;
+}
@@ -1,4 +1,7 @@
 #include "lib/fidesinnova.h"
+#include "lib/serialReader.h"
+#include "lib/mqttPublisher.h"
+#include "lib/proofEnvelope.h"
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -16,6 +19,9 @@
 #include <sys/ioctl.h>
 #include <net/if.h>
 #include <vector>
+#include <mutex>
+#include <map>
+#include <atomic>
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
@@ -25,11 +31,22 @@ std::string macBase64 = "";
 ordered_json proof;
 
 std::string MQTT_HOST = "";
+
+// Telemetry of button presses waiting for their proof, keyed by the
+// sequence number of the witness the reading submitted
+std::mutex pendingLock;
+std::map<uint64_t, ordered_json> pendingDocs;
 #define MQTT_PORT 8883
 #define MQTT_TOPIC "test"
 #define MQTT_KEEP_ALIVE 15
 #define MQTT_QOS 0
 #define MQTT_RETAIN false
+#define MQTT_QUEUE_CAPACITY 64
+#define MQTT_BATCH_SIZE 8
+#define MQTT_METRICS_INTERVAL 100
+// "json" sends the readable document; "cbor" or "msgpack" send a binary
+// envelope with the proof packed into a single blob (see lib/proofEnvelope.h)
+#define MQTT_PAYLOAD_FORMAT "json"
 
 // Base64 encoding table
 const std::string base64_chars =
@@ -119,39 +136,10 @@ std::string getMacAddress(const std::string& interface) {
 }
 
 
-int open_serial_port(const std::string &port) {
-    int fd = open(port.c_str(), O_RDWR | O_NOCTTY | O_NDELAY);
-    if (fd == -1) {
-        std::cerr << "Error: Unable to open serial port" << std::endl;
-        return -1;
-    }
-    
-    struct termios tty;
-    if (tcgetattr(fd, &tty) != 0) {
-        std::cerr << "Error: Failed to get terminal attributes" << std::endl;
-        close(fd);
-        return -1;
-    }
-    
-    cfsetospeed(&tty, B115200);
-    cfsetispeed(&tty, B115200);
-    tty.c_cflag |= (CLOCAL | CREAD);
-    tty.c_cflag &= ~PARENB;
-    tty.c_cflag &= ~CSTOPB;
-    tty.c_cflag &= ~CSIZE;
-    tty.c_cflag |= CS8;
-    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY);
-    tty.c_oflag &= ~OPOST;
-    tcsetattr(fd, TCSANOW, &tty);
-    
-    return fd;
-}
-
-
 void on_connect(struct mosquitto *mosq, void *obj, int rc) {
     if (rc == 0) {
         std::cout << "✅ Connected to MQTT broker." << std::endl;
+        static_cast<MqttPublisher *>(obj)->connected(true);
     } else {
         std::cerr << "❌ Failed to connect, return code: " << rc << " - " << mosquitto_strerror(rc) << std::endl;
         exit(EXIT_FAILURE);
@@ -159,9 +147,28 @@ void on_connect(struct mosquitto *mosq, void *obj, int rc) {
 }
 void on_publish(struct mosquitto *mosq, void *obj, int mid) {
     std::cout << "📢 Message ID " << mid << " published successfully!" << std::endl;
+    static_cast<MqttPublisher *>(obj)->published(mid);
 }
 void on_disconnect(struct mosquitto *mosq, void *obj, int rc) {
     std::cerr << "⚠️ Disconnected! Reason: " << rc << " - " << mosquitto_strerror(rc) << std::endl;
+    static_cast<MqttPublisher *>(obj)->connected(false);
+}
+
+// Function to queue a telemetry document; called from the main loop and the prover thread
+void publishDocument(MqttPublisher &publisher, const ordered_json &doc) {
+    static const PayloadFormat format = parsePayloadFormat(MQTT_PAYLOAD_FORMAT);
+    if (!publisher.publish(macBase64, encodeTelemetry(doc, format))) {
+        std::cerr << "❌ Publish queue full, dropping message" << std::endl;
+        return;
+    }
+
+    static std::atomic<uint64_t> documents{0};
+    if (++documents % MQTT_METRICS_INTERVAL == 0) {
+        MqttPublisher::Metrics m = publisher.metrics();
+        std::cout << "📊 MQTT queue depth " << m.queueDepth << " (max " << m.maxQueueDepth << "), published " << m.published
+                  << ", rejected " << m.rejected << ", failed " << m.failed << ", lost " << m.lost << ", latency avg " << m.averageLatencyMs
+                  << " ms, max " << m.maxLatencyMs << " ms" << std::endl;
+    }
 }
 
 std::string floatToStringOneDecimal(float value) {
@@ -197,8 +204,10 @@ int main() {
     std::string interface = "eno2"; // "eno2" is the interface
     macAddress = getMacAddress(interface);
     macBase64 = base64_encode(macAddress);
-    int serial_fd = open_serial_port("/dev/ttyACM0");
-    if (serial_fd == -1) {
+    // The sensor board streams JSON objects; frame them by brace balance so
+    // split and back-to-back messages are both handled.
+    SerialReader serial(SerialReader::Framing::JsonObject);
+    if (serial.open("/dev/ttyACM0") == -1) {
         return 1;
     }
 
@@ -221,6 +230,10 @@ int main() {
     mosquitto_int_option(mosq, MOSQ_OPT_PROTOCOL_VERSION, MQTT_PROTOCOL_V311);
     mosquitto_log_callback_set(mosq, [](mosquitto*, void*, int level, const char* msg) {
     });
+    // One network thread stays up for the life of the program and reconnects on
+    // its own; the publisher holds messages back while the broker is away.
+    MqttPublisher publisher(mosq, MQTT_QUEUE_CAPACITY, MQTT_BATCH_SIZE, MQTT_QOS, MQTT_RETAIN);
+    mosquitto_user_data_set(mosq, &publisher);
 
     std::ifstream inFile("broker_host.txt");
 
@@ -236,86 +249,99 @@ int main() {
         std::cerr << "❌ Connection failed: " << mosquitto_strerror(connect_res) << std::endl;
         return EXIT_FAILURE;
     }
+    if (!publisher.start()) {
+        return EXIT_FAILURE;
+    }
+
+    // Proofs are generated on the prover thread; publish each one that a
+    // button press is waiting for straight from memory.
+    fidesProver().onProofReady([&publisher](uint64_t sequence, const ordered_json &readyProof) {
+        ordered_json doc;
+        {
+            std::lock_guard<std::mutex> guard(pendingLock);
+            // Proofs come in witness order, so an older reading's proof was
+            // dropped by the full queue or failed and will not arrive
+            while (!pendingDocs.empty() && pendingDocs.begin()->first < sequence) {
+                std::cerr << "No proof for reading " << pendingDocs.begin()->first << ", not published" << std::endl;
+                pendingDocs.erase(pendingDocs.begin());
+            }
+            auto pending = pendingDocs.find(sequence);
+            if (pending == pendingDocs.end()) {
+                return;
+            }
+            doc = std::move(pending->second);
+            pendingDocs.erase(pending);
+        }
+        doc["data"]["proof"] = readyProof;
+        publishDocument(publisher, doc);
+    });
+    // fidesProver() is a static that outlives main: finish the queued proofs
+    // and join its thread while the publisher the callback uses still exists.
+    struct ProverShutdown {
+        ~ProverShutdown() {
+            fidesProver().stop();
+            fidesProver().onProofReady(nullptr);
+        }
+    } proverShutdown;
 
-    char buffer[256];
+    json parsed_json;
     while (true) {
-        int bytes_read = read(serial_fd, buffer, sizeof(buffer) - 1);
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            std::string input_data(buffer);
-
-            try {
-                // std::cout << "Input Data: " << input_data << std::endl;
-                json parsed_json = json::parse(input_data);
-                
-                asm volatile (
-                    "mov x18, #1\n"
-                    "mov x17, #1\n"
-                    "mul x17, x17, x18\n"
-                    "add x17, x17, #1\n"
-                );
-                if (parsed_json.contains("data")) {
-                    mosquitto_loop_stop(mosq, true);
-                    
-                    auto data = parsed_json["data"];
-                    float temperature = data.value("Temperature", 0.0f);
-                    float humidity = data.value("Humidity", 0.0f);
-                    std::string button_state = data.value("Button", "Unknown");
-
-                    std::string docString;
-                    ordered_json doc;
-                    if(button_state == "Pressed") {
-                        
-                        const char* proofJsonFilePath = "data/proof.json";
-                        nlohmann::json proofJsonData;
-                        std::ifstream proofJsonFile(proofJsonFilePath);
-                        proofJsonFile >> proofJsonData;
-                        proofJsonFile.close();
-                        if(temperature>120) temperature = 23.5;
-                        if(humidity>100) humidity = 15.0;
-                        doc.clear();
-                        doc["from"] = macBase64;
-                        doc["to"] = MQTT_HOST;
-                        doc["data"]["Framware Version"] = "1.7";
-                        doc["data"]["Hardware Version"] = "1";
-                        doc["data"]["Root"] = true;
-                        doc["data"]["Temperature"] = floatToStringOneDecimal(temperature) + " (°C)";
-                        doc["data"]["Humidity"] = floatToStringOneDecimal(humidity) + " (%)";
-                        doc["data"]["Button"] = button_state;
-                        doc["data"]["proof"] = proofJsonData;
-                        docString = doc.dump(4);
-                    }
-                    else {
-                        doc.clear();
-                        doc["from"] = macBase64;
-                        doc["to"] = MQTT_HOST;
-                        doc["data"]["Framware Version"] = "1.7";
-                        doc["data"]["Hardware Version"] = "1";
-                        doc["data"]["Root"] = true;
-                        doc["data"]["Temperature"] = floatToStringOneDecimal(temperature) + " (°C)";
-                        doc["data"]["Humidity"] = floatToStringOneDecimal(humidity) + " (%)";
-                        doc["data"]["Button"] = button_state;
-                        docString = doc.dump(4);
-                    }
-                    int mid;
-                    int rc = mosquitto_publish(mosq, &mid, macBase64.c_str(), strlen(docString.c_str()), docString.c_str(), MQTT_QOS, MQTT_RETAIN);
-                    if (rc != MOSQ_ERR_SUCCESS) {
-                        std::cerr << "❌ Publish failed: " << mosquitto_strerror(rc) << std::endl;
-                    } else {
-                        std::cout << "✅ Message published successfully!" << std::endl;
+        // Sleep in epoll until a complete message has arrived
+        if (!serial.next(parsed_json)) {
+            if (serial.closed()) {
+                // Exit non-zero so wizardry.sh restarts the program
+                std::cerr << "Serial port closed" << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        try {
+            asm volatile (
+                "mov x18, #1\n"
+                "mov x17, #1\n"
+                "mul x17, x17, x18\n"
+                "add x17, x17, #1\n"
+            );
+            if (parsed_json.contains("data")) {
+                auto data = parsed_json["data"];
+                float temperature = data.value("Temperature", 0.0f);
+                float humidity = data.value("Humidity", 0.0f);
+                std::string button_state = data.value("Button", "Unknown");
+
+                if(button_state == "Pressed") {
+                    if(temperature>120) temperature = 23.5;
+                    if(humidity>100) humidity = 15.0;
+                }
+                ordered_json doc;
+                doc["from"] = macBase64;
+                doc["to"] = MQTT_HOST;
+                doc["data"]["Framware Version"] = "1.7";
+                doc["data"]["Hardware Version"] = "1";
+                doc["data"]["Root"] = true;
+                doc["data"]["Temperature"] = floatToStringOneDecimal(temperature) + " (°C)";
+                doc["data"]["Humidity"] = floatToStringOneDecimal(humidity) + " (%)";
+                doc["data"]["Button"] = button_state;
+
+                if(button_state == "Pressed") {
+                    // The proof for this reading is still being computed; the
+                    // prover callback attaches it and publishes the message.
+                    uint64_t sequence = fidesProver().lastSubmitted();
+                    std::lock_guard<std::mutex> guard(pendingLock);
+                    if (sequence == 0 || !pendingDocs.emplace(sequence, doc).second) {
+                        std::cerr << "No new witness for this button press, not published" << std::endl;
                     }
-                    mosquitto_loop_start(mosq);
- 
-
-                    // std::cout << "data: " << data << std::endl;
-                } else {
-                    std::cerr << "Invalid JSON format: Missing 'data' field" << std::endl;
                 }
-            } catch (json::parse_error &e) {
-                std::cerr << "JSON Parse Error: " << e.what() << std::endl;
+                else {
+                    publishDocument(publisher, doc);
+                }
+
+                // std::cout << "data: " << data << std::endl;
+            } else {
+                std::cerr << "Invalid JSON format: Missing 'data' field" << std::endl;
             }
+        } catch (json::exception &e) {
+            std::cerr << "JSON Error: " << e.what() << std::endl;
         }
     }
-    close(serial_fd);
     return 0;
 }
@@ -0,0 +1,127 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the verifying key and batch verification against data/program_commitment.json and data/proof.json.
+// `g++ -std=c++17 proofVerifier_test.cpp lib/proofVerifier.cpp lib/verifyingKey.cpp lib/polynomial.cpp lib/proofEnvelope.cpp lib/srs.cpp -o proofVerifier_test`
+
+#include "lib/proofVerifier.h"
+#include "lib/polynomial.h"
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdio>
+#include <unistd.h>
+
+ordered_json readJson(const string& path) {
+    std::ifstream file(path);
+    assert(file.is_open());
+    ordered_json data;
+    file >> data;
+    return data;
+}
+
+void test_verifying_key(const VerifyingKey& key) {
+    uint64_t p = key.p;
+
+    // The closed forms match the products over the domains
+    vector<uint64_t> K, H;
+    for (uint64_t i = 0, k = 1; i < key.m; i++, k = (k * key.omegaK) % p) {
+        K.push_back(k);
+    }
+    for (uint64_t i = 0, h = 1; i < key.n; i++, h = (h * key.omegaH) % p) {
+        H.push_back(h);
+    }
+    uint64_t x = 123457;
+    assert(key.vK(x) == Polynomial::evaluatePolynomial(Polynomial::expandPolynomials(K, p), x, p));
+    assert(key.vH(x) == Polynomial::evaluatePolynomial(Polynomial::expandPolynomials(H, p), x, p));
+    assert(key.vH(H[5]) == 0 && key.vK(K[key.m - 1]) == 0);
+
+    // Barycentric x_hat matches the Newton interpolation the prover uses
+    vector<uint64_t> values;
+    for (size_t i = 0; i < key.zero_to_t_for_H.size(); i++) {
+        values.push_back((i * 7919 + 3) % p);
+    }
+    vector<uint64_t> x_hat = Polynomial::setupNewtonPolynomial(key.zero_to_t_for_H, values, p, "x_hat(h)");
+    assert(key.interpolate(values, x) == Polynomial::evaluatePolynomial(x_hat, x, p));
+    assert(key.interpolate(values, key.zero_to_t_for_H[4]) == values[4]);
+
+    // Serialisation round trip; a truncated file is refused
+    const char* path = "proofVerifier_test.vk";
+    bool written = writeVerifyingKey(path, key);
+    assert(written);
+    VerifyingKey read;
+    bool loaded = readVerifyingKey(path, read);
+    assert(loaded);
+    assert(read.source == key.source && read.commitmentId == key.commitmentId && read.vk == key.vk);
+    assert(read.valC_x == key.valC_x && read.xHatWeights == key.xHatWeights && read.v_H == key.v_H);
+    // So is a key whose x_hat weights do not match its points
+    VerifyingKey inconsistent = key;
+    inconsistent.xHatWeights.pop_back();
+    written = writeVerifyingKey(path, inconsistent);
+    assert(written);
+    loaded = readVerifyingKey(path, read);
+    assert(!loaded);
+    written = writeVerifyingKey(path, key);
+    assert(written);
+    int truncated = truncate(path, 100);
+    assert(truncated == 0);
+    loaded = readVerifyingKey(path, read);
+    assert(!loaded);
+    std::remove(path);
+    std::cout << "verifying key: ok\n";
+}
+
+void test_single(const VerifyingKey& key, const ordered_json& proof) {
+    assert(evaluateProof(key, proof).holds());
+
+    ordered_json tampered = proof;
+    tampered["P_AHP1"] = tampered["P_AHP1"].get<uint64_t>() + 1;
+    assert(!evaluateProof(key, tampered).holds());
+    std::cout << "single: ok\n";
+}
+
+void test_batch(const VerifyingKey& key, const ordered_json& proof) {
+    vector<size_t> failed;
+    vector<ordered_json> proofs(5, proof);
+    bool verified = verifyBatch(key, proofs, failed);
+    assert(verified && failed.empty());
+
+    // A single bad proof fails the whole batch
+    proofs[4]["P_AHP1"] = proofs[4]["P_AHP1"].get<uint64_t>() + 1;
+    verified = verifyBatch(key, proofs, failed);
+    assert(!verified && failed == vector<size_t>({ 4 }));
+    proofs[4] = proof;
+
+    // The bad proofs are named
+    proofs[1]["P_AHP10"] = proofs[1]["P_AHP10"].get<uint64_t>() + 1;
+    proofs[3]["P_AHP13"] = proofs[3]["P_AHP13"].get<uint64_t>() + 1;
+    verified = verifyBatch(key, proofs, failed);
+    assert(!verified && failed == vector<size_t>({ 1, 3 }));
+
+    // A proof for another commitment is rejected without being evaluated
+    proofs = vector<ordered_json>(3, proof);
+    proofs[2]["commitmentId"] = "other";
+    verified = verifyBatch(key, proofs, failed);
+    assert(!verified && failed == vector<size_t>({ 2 }));
+    std::cout << "batch: ok\n";
+}
+
+int main() {
+    VerifyingKey key = loadVerifyingKey();
+    ordered_json proof = readJson("data/proof.json");
+    test_verifying_key(key);
+    test_single(key, proof);
+    test_batch(key, proof);
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Feeds SerialReader through a pseudo-terminal, so no sensor board is needed.
+// `g++ -std=c++17 serialReader_test.cpp lib/serialReader.cpp -o serialReader_test -lutil`
+
+#include "lib/serialReader.h"
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+struct Pty {
+    int master = -1;
+    int slave = -1;
+
+    Pty() {
+        int opened = openpty(&master, &slave, nullptr, nullptr, nullptr);
+        assert(opened == 0);
+        struct termios tty;
+        tcgetattr(slave, &tty);
+        cfmakeraw(&tty);
+        tcsetattr(slave, TCSANOW, &tty);
+    }
+    ~Pty() {
+        if (master != -1) close(master);
+        if (slave != -1) close(slave);
+    }
+    void send(const std::string &bytes) {
+        ssize_t written = write(master, bytes.data(), bytes.size());
+        assert(written == (ssize_t)bytes.size());
+    }
+};
+
+void test_partial_message() {
+    Pty pty;
+    SerialReader reader(SerialReader::Framing::JsonObject);
+    bool attached = reader.attach(pty.slave);
+    assert(attached);
+
+    json message;
+    bool received;
+    pty.send("{\"data\":{\"Temperature\":2");
+    received = reader.next(message, 50);
+    assert(!received);
+    pty.send("3.5,\"Button\":\"Pressed\"}}");
+    received = reader.next(message, 1000);
+    assert(received);
+    assert(message["data"]["Temperature"] == 23.5);
+    assert(message["data"]["Button"] == "Pressed");
+    std::cout << "partial message: ok\n";
+}
+
+void test_coalesced_messages() {
+    Pty pty;
+    SerialReader reader(SerialReader::Framing::JsonObject);
+    bool attached = reader.attach(pty.slave);
+    assert(attached);
+
+    json message;
+    bool received;
+    pty.send("{\"a\":1}\r\n{\"b\":\"}{\\\"\"}  {\"c\":[{\"d\":2}]}");
+    received = reader.next(message, 1000);
+    assert(received && message["a"] == 1);
+    received = reader.next(message, 1000);
+    assert(received && message["b"] == "}{\"");
+    received = reader.next(message, 1000);
+    assert(received && message["c"][0]["d"] == 2);
+    received = reader.next(message, 50);
+    assert(!received);
+    std::cout << "coalesced messages: ok\n";
+}
+
+void test_newline_framing() {
+    Pty pty;
+    SerialReader reader(SerialReader::Framing::Newline);
+    bool attached = reader.attach(pty.slave);
+    assert(attached);
+
+    json message;
+    bool received;
+    pty.send("not json\r\n{\"data\":");
+    pty.send("{\"Humidity\":40}}\n");
+    received = reader.next(message, 1000);
+    assert(received);
+    assert(message["data"]["Humidity"] == 40);
+    assert(reader.parseErrors() == 1);
+    std::cout << "newline framing: ok\n";
+}
+
+void test_length_framing() {
+    Pty pty;
+    SerialReader reader(SerialReader::Framing::LengthPrefixed);
+    bool attached = reader.attach(pty.slave);
+    assert(attached);
+
+    std::string body = "{\"n\":7}";
+    std::string frame = std::string("\0\0\0", 3) + char(body.size()) + body;
+    json message;
+    bool received;
+    pty.send(frame + frame.substr(0, 6));
+    received = reader.next(message, 1000);
+    assert(received && message["n"] == 7);
+    received = reader.next(message, 50);
+    assert(!received);
+    pty.send(frame.substr(6));
+    received = reader.next(message, 1000);
+    assert(received && message["n"] == 7);
+    std::cout << "length framing: ok\n";
+}
+
+void test_overflow_and_hangup() {
+    Pty pty;
+    SerialReader reader(SerialReader::Framing::JsonObject, 64);
+    bool attached = reader.attach(pty.slave);
+    assert(attached);
+
+    json message;
+    bool received;
+    pty.send("{\"junk\":\"" + std::string(100, 'x'));
+    received = reader.next(message, 50);
+    assert(!received);
+    received = reader.next(message, 50);
+    assert(!received);
+    assert(reader.overflows() == 1);
+    pty.send("\"}{\"ok\":true}");
+    received = reader.next(message, 1000);
+    assert(received && message["ok"] == true);
+
+    close(pty.master);
+    pty.master = -1;
+    received = reader.next(message, 1000);
+    assert(!received);
+    assert(reader.closed());
+    std::cout << "overflow and hangup: ok\n";
+}
+
+int main() {
+    test_partial_message();
+    test_coalesced_messages();
+    test_newline_framing();
+    test_length_framing();
+    test_overflow_and_hangup();
+    std::cout << "All serial reader tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,335 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generates a class.json entry for any gate count. p is the smallest prime of
+// the form c * lcm(n, m, 2^k) + 1, so H (size n), K (size m) and radix-2
+// transforms of every length up to 2^k all exist in F_p; g is the smallest
+// generator of F_p*.
+//
+//   ./classGenerator <n_g> [--class N] [--two-adicity k] [--min-bits b] [--write ../class.json]
+//   ./classGenerator --audit ../class.json
+//
+// `g++ -std=c++17 -O2 classGenerator.cpp -o classGenerator`
+
+#include <stdint.h>
+#include <fstream>
+#include "../lib/json.hpp"
+using ordered_json = nlohmann::ordered_json;
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+
+using namespace std;
+
+const uint64_t defaultInputs = 32;
+
+uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p) {
+    return (unsigned __int128)a * b % p;
+}
+
+uint64_t powMod(uint64_t base, uint64_t exponent, uint64_t p) {
+    uint64_t result = 1;
+    base %= p;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = mulMod(result, base, p);
+        }
+        base = mulMod(base, base, p);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+// Function to test primality; the bases make Miller-Rabin exact below 2^64
+bool isPrime(uint64_t n) {
+    if (n < 2) {
+        return false;
+    }
+    for (uint64_t q : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        if (n % q == 0) {
+            return n == q;
+        }
+    }
+    uint64_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+    for (uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        uint64_t x = powMod(a, d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool composite = true;
+        for (int r = 1; r < s; r++) {
+            x = mulMod(x, x, n);
+            if (x == n - 1) {
+                composite = false;
+                break;
+            }
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to get the distinct prime factors of n by trial division
+vector<uint64_t> primeFactors(uint64_t n) {
+    vector<uint64_t> factors;
+    for (uint64_t q = 2; q * q <= n; q += (q == 2 ? 1 : 2)) {
+        if (n % q == 0) {
+            factors.push_back(q);
+            while (n % q == 0) {
+                n /= q;
+            }
+        }
+    }
+    if (n > 1) {
+        factors.push_back(n);
+    }
+    return factors;
+}
+
+uint64_t gcd(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Function to count the factors of two in n
+int twoAdicity(uint64_t n) {
+    int k = 0;
+    while (n > 0 && (n & 1) == 0) {
+        n >>= 1;
+        k++;
+    }
+    return k;
+}
+
+// Function to find the smallest generator of F_p*. p - 1 = c * base, and the
+// primes of base are already known, so only c has to be factored.
+uint64_t findGenerator(uint64_t p, uint64_t c, uint64_t base) {
+    vector<uint64_t> factors = primeFactors(base);
+    for (uint64_t q : primeFactors(c)) {
+        if (base % q != 0) {
+            factors.push_back(q);
+        }
+    }
+    for (uint64_t g = 2; g < p; g++) {
+        bool generator = true;
+        for (uint64_t q : factors) {
+            if (powMod(g, (p - 1) / q, p) == 1) {
+                generator = false;
+                break;
+            }
+        }
+        if (generator) {
+            return g;
+        }
+    }
+    return 0;
+}
+
+// Function to audit the primes of an existing class.json
+int audit(const string& path) {
+    ifstream classFile(path);
+    if (!classFile.is_open()) {
+        cerr << "Could not open " << path << endl;
+        return 1;
+    }
+    ordered_json classJsonData;
+    classFile >> classJsonData;
+
+    cout << "class      n_g            p  2-adicity  n|p-1  m|p-1  g generates" << endl;
+    for (auto it = classJsonData.begin(); it != classJsonData.end(); ++it) {
+        uint64_t n = it.value()["n"].get<uint64_t>();
+        uint64_t m = it.value()["m"].get<uint64_t>();
+        uint64_t p = it.value()["p"].get<uint64_t>();
+        uint64_t g = it.value()["g"].get<uint64_t>();
+        bool generates = true;
+        for (uint64_t q : primeFactors(p - 1)) {
+            if (powMod(g, (p - 1) / q, p) == 1) {
+                generates = false;
+                break;
+            }
+        }
+        printf("%5s %8lu %12lu %10d %6s %6s  %s\n", it.key().c_str(), (unsigned long)it.value()["n_g"].get<uint64_t>(),
+               (unsigned long)p, twoAdicity(p - 1), (p - 1) % n == 0 ? "yes" : "no", (p - 1) % m == 0 ? "yes" : "no",
+               generates ? "yes" : "no");
+    }
+    return 0;
+}
+
+// Function to print the command line and fail
+int usage(const char* program) {
+    cerr << "Usage: " << program << " <n_g> [--class N] [--two-adicity k] [--min-bits b] [--write class.json]" << endl;
+    cerr << "       " << program << " --audit class.json" << endl;
+    return 1;
+}
+
+// Function to parse a non-negative decimal number; false for anything else
+bool parseNumber(const char* text, uint64_t& value) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    char* end;
+    errno = 0;
+    value = strtoull(text, &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && strcmp(argv[1], "--audit") == 0) {
+        if (argc != 3) {
+            return usage(argv[0]);
+        }
+        return audit(argv[2]);
+    }
+    uint64_t n_g;
+    if (argc < 2 || !parseNumber(argv[1], n_g)) {
+        return usage(argv[0]);
+    }
+
+    uint64_t n_i = defaultInputs;
+    string classKey;
+    string writePath;
+    int k = -1;
+    int minBits = 21;
+    for (int i = 2; i < argc; i += 2) {
+        string option = argv[i];
+        if (option != "--class" && option != "--two-adicity" && option != "--min-bits" && option != "--write") {
+            cerr << "Unknown option " << option << endl;
+            return usage(argv[0]);
+        }
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << option << endl;
+            return usage(argv[0]);
+        }
+        const char* value = argv[i + 1];
+        uint64_t number = 0;
+        if ((option == "--two-adicity" || option == "--min-bits") && (!parseNumber(value, number) || number > 64)) {
+            cerr << "Invalid value " << value << " for " << option << endl;
+            return 1;
+        }
+        if (option == "--class") {
+            classKey = value;
+        } else if (option == "--two-adicity") {
+            k = int(number);
+        } else if (option == "--min-bits") {
+            minBits = int(number);
+        } else {
+            writePath = value;
+        }
+    }
+    if (n_g == 0) {
+        cerr << "n_g must be positive" << endl;
+        return 1;
+    }
+
+    // Same sizes the commitmentGenerator and setup use
+    uint64_t n = n_g + n_i + 1;
+    uint64_t m = 2 * n_g;
+    uint64_t d_AHP = max(((12 * n_g) - 6), ((3 * n_g) + (2 * n_i) + 1));
+    if (k < 0) {
+        // Room for radix-2 transforms of products of polynomials of degree d_AHP
+        k = 1;
+        while ((uint64_t(1) << k) < 2 * d_AHP) {
+            k++;
+        }
+    }
+    if (k > 62) {
+        cerr << "2-adicity " << k << " is too large for 64-bit primes" << endl;
+        return 1;
+    }
+
+    uint64_t base = n / gcd(n, m) * m;
+    uint64_t power = uint64_t(1) << k;
+    if (base / gcd(base, power) > UINT64_MAX / power) {
+        cerr << "lcm(n, m, 2^" << k << ") does not fit in 64 bits" << endl;
+        return 1;
+    }
+    base = base / gcd(base, power) * power;
+
+    uint64_t minimum = minBits > 0 ? (uint64_t(1) << (minBits - 1)) : 2;
+    uint64_t c = minimum > base ? (minimum - 1) / base : 1;
+    if (c == 0) {
+        c = 1;
+    }
+    uint64_t p = 0;
+    for (; c <= (UINT64_MAX - 1) / base; c++) {
+        if (isPrime(c * base + 1)) {
+            p = c * base + 1;
+            break;
+        }
+    }
+    if (p == 0) {
+        cerr << "No prime found" << endl;
+        return 1;
+    }
+    uint64_t g = findGenerator(p, c, base);
+
+    ordered_json entry;
+    entry["n_g"] = n_g;
+    entry["n_i"] = n_i;
+    entry["n"] = n;
+    entry["m"] = m;
+    entry["p"] = p;
+    entry["g"] = g;
+
+    cerr << "p - 1 = " << c << " * " << base << ", 2-adicity " << twoAdicity(p - 1) << endl;
+    if (p > UINT32_MAX) {
+        cerr << "Warning: p is above 2^32, so products of two field elements need 128-bit arithmetic" << endl;
+    }
+
+    if (writePath.empty()) {
+        ordered_json out;
+        out[classKey.empty() ? to_string(n_g) : classKey] = entry;
+        cout << out.dump(2) << endl;
+        return 0;
+    }
+
+    ordered_json classJsonData;
+    {
+        ifstream classFile(writePath);
+        if (classFile.is_open()) {
+            classFile >> classJsonData;
+        }
+    }
+    if (classKey.empty()) {
+        // Next free class number
+        uint64_t next = 1;
+        while (classJsonData.contains(to_string(next))) {
+            next++;
+        }
+        classKey = to_string(next);
+    }
+    classJsonData[classKey] = entry;
+    ofstream classFile(writePath);
+    if (!classFile.is_open()) {
+        cerr << "Could not open " << writePath << " for writing" << endl;
+        return 1;
+    }
+    classFile << classJsonData.dump(2);
+    cout << "Class " << classKey << " has been written to " << writePath << endl;
+    return 0;
+}
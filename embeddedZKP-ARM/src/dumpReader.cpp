@@ -0,0 +1,83 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Lists the records of a debug dump written with FIDES_DEBUG_DUMP=<file>.
+//
+//   ./dumpReader <file>            name and shape of every record, and its first values
+//   ./dumpReader <file> <name>     every value of the records called <name>
+//
+// `g++ -std=c++17 -O2 dumpReader.cpp -o dumpReader`
+
+#include <stdint.h>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <dump file> [record name]" << endl;
+        return 1;
+    }
+    FILE* file = fopen(argv[1], "rb");
+    if (!file) {
+        cerr << "Could not open " << argv[1] << endl;
+        return 1;
+    }
+    string selected = argc > 2 ? argv[2] : "";
+
+    const uint64_t preview = 8;
+    uint32_t length;
+    while (fread(&length, sizeof(length), 1, file) == 1) {
+        string name(length, '\0');
+        uint64_t rows, columns;
+        if (fread(&name[0], 1, length, file) != length || fread(&rows, sizeof(rows), 1, file) != 1 ||
+            fread(&columns, sizeof(columns), 1, file) != 1) {
+            cerr << "Truncated record header" << endl;
+            fclose(file);
+            return 1;
+        }
+        bool all = selected == name;
+        if (!selected.empty() && !all) {
+            fseek(file, long(rows * columns * sizeof(uint64_t)), SEEK_CUR);
+            continue;
+        }
+
+        cout << name << " [" << rows << " x " << columns << "]";
+        vector<uint64_t> row(columns);
+        for (uint64_t r = 0; r < rows; r++) {
+            if (fread(row.data(), sizeof(uint64_t), columns, file) != columns) {
+                cerr << endl << "Truncated record " << name << endl;
+                fclose(file);
+                return 1;
+            }
+            if (!all && r > 0) {
+                continue;
+            }
+            cout << (all && rows > 1 ? "\n  " : " ");
+            uint64_t shown = all ? columns : min(columns, preview);
+            for (uint64_t i = 0; i < shown; i++) {
+                cout << row[i] << (i + 1 < shown ? " " : "");
+            }
+            if (shown < columns) {
+                cout << " ...";
+            }
+        }
+        cout << endl;
+    }
+    fclose(file);
+    return 0;
+}
@@ -17,18 +17,99 @@
 #include <fstream>
 #include "../lib/json.hpp"
 using ordered_json = nlohmann::ordered_json;
+#include "../lib/srs.h"
 #include <regex>
 #include <iostream>
 #include <random>
+#include <chrono>
+#include <functional>
+#include <thread>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 using namespace std;
 
+// Function to check if the "data" directory exists, and create it if not
+bool createDataDirectory() {
+    struct stat info;
+    if (stat("data", &info) != 0) {
+        cout << "Data directory does not exist. Creating 'data' directory." << endl;
+        if (mkdir("data", 0777) == -1) {
+            cerr << "Error creating data directory!" << endl;
+            return false;
+        }
+    } else if (!(info.st_mode & S_IFDIR)) {
+        cerr << "'data' exists but is not a directory!" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Number of ck elements computed and written per round; memory stays at this
+// size whatever the degree
+const uint64_t chunkSize = 1 << 16;
+
+uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p) {
+    return (unsigned __int128)a * b % p;
+}
+
+uint64_t powMod(uint64_t base, uint64_t exponent, uint64_t p) {
+    uint64_t result = 1;
+    base %= p;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = mulMod(result, base, p);
+        }
+        base = mulMod(base, base, p);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+// Function to generate ck[i] = g * tau^i for i < degree, chunkSize elements at
+// a time. Each chunk is split into one block per thread; a block starts from
+// g * tau^start and continues with one multiplication per element. Every
+// chunk is handed to write in order before the next one is computed.
+void generateCommitmentKey(uint64_t g, uint64_t tau, uint64_t p, uint64_t degree,
+                           const function<void(const uint64_t*, size_t)>& write) {
+    unsigned threadCount = max(1u, std::thread::hardware_concurrency());
+    vector<uint64_t> chunk(min(degree, chunkSize));
+    for (uint64_t first = 0; first < degree; first += chunkSize) {
+        uint64_t count = min(chunkSize, degree - first);
+        uint64_t blockSize = (count + threadCount - 1) / threadCount;
+        auto block = [&](uint64_t begin, uint64_t end) {
+            uint64_t value = mulMod(g, powMod(tau, first + begin, p), p);
+            for (uint64_t i = begin; i < end; i++) {
+                chunk[i] = value;
+                value = mulMod(value, tau, p);
+            }
+        };
+        vector<thread> threads;
+        for (uint64_t begin = blockSize; begin < count; begin += blockSize) {
+            threads.emplace_back(block, begin, min(count, begin + blockSize));
+        }
+        block(0, min(count, blockSize));
+        for (auto& worker : threads) {
+            worker.join();
+        }
+        write(chunk.data(), count);
+    }
+}
+
+// Function to pick tau uniformly from 2..p-1
+uint64_t randomTau(uint64_t p) {
+    static std::random_device rd;
+    static std::mt19937_64 gen(rd());
+    std::uniform_int_distribution<uint64_t> dis(2, p - 1);
+    return dis(gen);
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
 void setup() {
-    vector<uint64_t> ck;
-    uint64_t vk;
 
     nlohmann::json classJsonData;
     // Open the JSON file for reading (class.json)
@@ -63,77 +144,46 @@ void setup() {
             cout << "  g: " << g << endl;
 
             // Validate p and g
-            if (p <= 1) {
+            if (p <= 2) {
                 cout << "Invalid p value for Class " << class_value << ": " << p << endl;
             } else {
-                uint64_t d_AHP = max(((12 * n_g) - 6), ((3 * n_g) + (2 * n_i) + 1));
-
-                // Calculate new power for g based on d_AHP
-                uint64_t pMinusOne = p - 1;
+                auto start = std::chrono::steady_clock::now();
+                uint64_t d_AHP = ahpDegree(n_g, n_i);
+                uint64_t tau = randomTau(p);
 
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<uint64_t> dis(1, pMinusOne);
-                uint64_t tau = dis(gen);
-                tau %= pMinusOne;
-
-                // Push values into ck
-                ck.clear(); // Clear previous values
-
-                for (uint64_t i = 0; i < d_AHP; i++) {
-                    ck.push_back(g);
-                    g = (g * tau) % p;
+                if (!createDataDirectory()) {
+                    return;
+                }
+                std::ofstream setupFile("data/setup" + to_string(class_value) + ".json");
+                if (!setupFile.is_open()) {
+                    cerr << "Error opening file for writing setup" << class_value << ".json\n";
+                    continue;
                 }
 
-                // Output ck for verification
-                cout << "ck = {";
-                for (uint64_t i = 0; i < ck.size(); i++) {
-                    cout << ck[i];
-                    if (ck.size() - i > 1) {
-                        cout << ", ";
+                // Streamed in the layout of ordered_json::dump(4), so ck is never
+                // held in memory as a whole
+                uint64_t vk = 0;
+                uint64_t written = 0;
+                setupFile << "{\n    \"class\": " << class_value << ",\n    \"ck\": [";
+                generateCommitmentKey(g, tau, p, d_AHP, [&](const uint64_t* values, size_t count) {
+                    for (size_t i = 0; i < count; i++, written++) {
+                        setupFile << (written == 0 ? "\n        " : ",\n        ") << values[i];
+                        if (written == 1) {
+                            vk = values[i];
+                        }
                     }
-                }
-                cout << "}" << endl;
+                });
+                setupFile << (written == 0 ? "]" : "\n    ]") << ",\n    \"vk\": " << vk << "\n}";
+                setupFile.close();
 
                 // Retrieve verifying key
-                if (ck.size() > 1) {
-                    vk = ck[1];
+                if (d_AHP > 1) {
                     cout << "vk = " << vk << endl;
                 } else {
                     cout << "Error: ck does not have enough elements." << endl;
-                    vk = 0; // Set vk to 0 if ck is insufficient
-                }
-
-                // Create JSON object
-                ordered_json setupJson;
-                setupJson["class"] = class_value;
-                setupJson["ck"] = ck;
-                setupJson["vk"] = vk;
-
-                // Serialize JSON object to a string
-                string setupString = setupJson.dump(4); // Pretty print with 4-space indentation
-
-                // Write JSON object to a file
-                // Check if the "data" directory exists, if not, create it
-                struct stat info;
-                if (stat("data", &info) != 0) {
-                    cout << "Data directory does not exist. Creating 'data' directory." << endl;
-                    if (mkdir("data", 0777) == -1) {
-                        cerr << "Error creating data directory!" << endl;
-                        return;
-                    }
-                } else if (!(info.st_mode & S_IFDIR)) {
-                    cerr << "'data' exists but is not a directory!" << endl;
-                    return;
-                }
-                std::ofstream setupFile("data/setup" + to_string(class_value) + ".json");
-                if (setupFile.is_open()) {
-                    setupFile << setupString;
-                    setupFile.close();
-                    cout << "JSON data has been written to setup" << class_value << ".json\n";
-                } else {
-                    cerr << "Error opening file for writing setup" << class_value << ".json\n";
                 }
+                cout << "JSON data has been written to setup" << class_value << ".json (" << d_AHP << " elements in "
+                     << secondsSince(start) << " s)\n";
             }
         } else {
             cout << "Class " << class_value << " not found in JSON.\n";
@@ -141,6 +191,121 @@ void setup() {
     }
 }
 
-int main() {
-    setup();
+// Function to write data/setup<class>.json from a ck already in memory, in the
+// same layout as setup()
+bool writeSetupFile(const string& Class, const uint64_t* ck, uint64_t degree) {
+    std::ofstream setupFile("data/setup" + Class + ".json");
+    if (!setupFile.is_open()) {
+        return false;
+    }
+    setupFile << "{\n    \"class\": " << Class << ",\n    \"ck\": [";
+    for (uint64_t i = 0; i < degree; i++) {
+        setupFile << (i == 0 ? "\n        " : ",\n        ") << ck[i];
+    }
+    setupFile << (degree == 0 ? "]" : "\n    ]") << ",\n    \"vk\": " << (degree > 1 ? ck[1] : 0) << "\n}";
+    setupFile.close();
+    return !setupFile.fail();
+}
+
+// Function to write one universal SRS, data/srs.bin, instead of a setup file
+// per class. Classes with the same p and g share one tau and one ck sized for
+// the largest of them; each class uses the prefix it needs. The setup file of
+// every class is rewritten from the same prefix, so both agree.
+void universalSetup() {
+    ordered_json classJsonData;
+    std::ifstream classFile("../class.json");
+    if (!classFile.is_open()) {
+        cerr << "Could not open class.json!" << endl;
+        return;
+    }
+    classFile >> classJsonData;
+    classFile.close();
+
+    vector<SrsSection> sections;
+    vector<pair<string, size_t>> classSections;
+    for (auto it = classJsonData.begin(); it != classJsonData.end(); ++it) {
+        uint64_t n_g = it.value()["n_g"].get<uint64_t>();
+        uint64_t n_i = it.value()["n_i"].get<uint64_t>();
+        uint64_t p   = it.value()["p"].get<uint64_t>();
+        uint64_t g   = it.value()["g"].get<uint64_t>();
+        if (p <= 2) {
+            cout << "Invalid p value for Class " << it.key() << ": " << p << endl;
+            continue;
+        }
+        uint64_t d_AHP = ahpDegree(n_g, n_i);
+        size_t index = 0;
+        while (index < sections.size() && (sections[index].p != p || sections[index].g != g)) {
+            index++;
+        }
+        if (index == sections.size()) {
+            sections.push_back({p, g, d_AHP, 0});
+        }
+        sections[index].degree = max(sections[index].degree, d_AHP);
+        classSections.push_back({it.key(), index});
+    }
+
+    if (!createDataDirectory()) {
+        return;
+    }
+    SrsWriter writer;
+    if (!writer.open(srsFilePath, sections)) {
+        cerr << "Error opening file for writing " << srsFilePath << endl;
+        return;
+    }
+
+    for (size_t index = 0; index < sections.size(); index++) {
+        const SrsSection& section = sections[index];
+        auto start = std::chrono::steady_clock::now();
+        uint64_t vk = 0;
+        uint64_t written = 0;
+        bool ok = true;
+        generateCommitmentKey(section.g, randomTau(section.p), section.p, section.degree, [&](const uint64_t* values, size_t count) {
+            if (written == 0 && count > 1) {
+                vk = values[1];
+            }
+            written += count;
+            ok = writer.append(values, count) && ok;
+        });
+        if (!ok) {
+            cerr << "Error writing " << srsFilePath << endl;
+            writer.close();
+            return;
+        }
+        cout << "section " << index << ": p: " << section.p << "  g: " << section.g << "  degree: " << section.degree
+             << "  vk: " << vk << "  (" << secondsSince(start) << " s)" << endl;
+    }
+    if (!writer.close()) {
+        cerr << "Error writing " << srsFilePath << endl;
+        return;
+    }
+
+    UniversalSRS srs;
+    if (!srs.open(srsFilePath)) {
+        cerr << "Error reading back " << srsFilePath << endl;
+        return;
+    }
+    for (const auto& classSection : classSections) {
+        const auto& entry = classJsonData[classSection.first];
+        CommitmentKey key;
+        if (!srs.find(entry["p"].get<uint64_t>(), entry["g"].get<uint64_t>(),
+                      ahpDegree(entry["n_g"].get<uint64_t>(), entry["n_i"].get<uint64_t>()), key) ||
+            !writeSetupFile(classSection.first, key.data, key.size)) {
+            cerr << "Error writing setup" << classSection.first << ".json" << endl;
+            return;
+        }
+        cout << "class " << classSection.first << " uses section " << classSection.second << ", vk " << key.vk << endl;
+    }
+    cout << sections.size() << " section(s) for " << classSections.size() << " classes have been written to " << srsFilePath << endl;
+}
+
+// Usage: ./setup                 writes data/setup<class>.json for every class
+//        ./setup --universal     writes the single data/srs.bin and the
+//                                data/setup<class>.json files matching it
+// `g++ -std=c++17 -O2 setup.cpp ../lib/srs.cpp -o setup -lpthread`
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--universal") {
+        universalSetup();
+    } else {
+        setup();
+    }
 }
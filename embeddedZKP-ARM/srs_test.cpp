@@ -0,0 +1,119 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Writes a small universal SRS and checks the prefix views served from it.
+// `g++ -std=c++17 srs_test.cpp lib/srs.cpp lib/polynomial.cpp -o srs_test`
+
+#include "lib/srs.h"
+#include "lib/polynomial.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <unistd.h>
+
+const char* path = "srs_test.bin";
+
+// Function to write two sections, ck[i] = g * tau^i, and return their keys
+vector<vector<uint64_t>> writeFile() {
+    vector<SrsSection> sections = { { 1678321, 11, 40, 0 }, { 5087281, 7, 100, 0 } };
+    vector<uint64_t> taus = { 1234, 98765 };
+    vector<vector<uint64_t>> keys;
+    SrsWriter writer;
+    bool opened = writer.open(path, sections);
+    assert(opened);
+    assert(sections[0].offset == sizeof(SrsHeader) + 2 * sizeof(SrsSection));
+    assert(sections[1].offset == sections[0].offset + 40 * sizeof(uint64_t));
+    for (size_t s = 0; s < sections.size(); s++) {
+        vector<uint64_t> ck;
+        uint64_t value = sections[s].g;
+        for (uint64_t i = 0; i < sections[s].degree; i++) {
+            ck.push_back(value);
+            value = value * taus[s] % sections[s].p;
+        }
+        // Written in uneven pieces, the way setup streams it
+        bool appended = writer.append(ck.data(), 3);
+        appended = appended && writer.append(ck.data() + 3, ck.size() - 3);
+        assert(appended);
+        keys.push_back(ck);
+    }
+    bool closed = writer.close();
+    assert(closed);
+    return keys;
+}
+
+void test_prefix_views() {
+    vector<vector<uint64_t>> keys = writeFile();
+    UniversalSRS srs;
+    bool opened = srs.open(path);
+    assert(opened);
+    assert(srs.sectionList().size() == 2);
+
+    CommitmentKey key;
+    bool found = srs.find(5087281, 7, 60, key);
+    assert(found);
+    assert(key.size == 60 && key.vk == keys[1][1] && !key.storage);
+    for (uint64_t i = 0; i < 60; i++) {
+        assert(key[i] == keys[1][i]);
+    }
+
+    vector<uint64_t> polynomial = { 3, 1, 4, 1, 5, 9, 2, 6 };
+    assert(Polynomial::KZG_Commitment(key, polynomial, 5087281) == Polynomial::KZG_Commitment(keys[1], polynomial, 5087281));
+
+    found = srs.find(1678321, 11, 40, key);
+    assert(found && key[39] == keys[0][39]);
+    found = srs.find(1678321, 11, 41, key);   // longer than the section
+    assert(!found);
+    found = srs.find(1678321, 7, 10, key);    // other generator
+    assert(!found);
+    std::cout << "prefix views: ok\n";
+}
+
+void test_rejects_bad_files() {
+    writeFile();
+    FILE* file = fopen(path, "r+b");
+    fputc('X', file);
+    fclose(file);
+    UniversalSRS srs;
+    bool opened = srs.open(path);
+    assert(!opened);
+
+    // Truncated: the section table points past the end
+    writeFile();
+    file = fopen(path, "r+b");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    int truncated = truncate(path, size - 8);
+    assert(truncated == 0);
+    opened = srs.open(path);
+    assert(!opened);
+    opened = srs.open("missing_srs_test.bin");
+    assert(!opened);
+    std::remove(path);
+    std::cout << "bad files: ok\n";
+}
+
+void test_json_key() {
+    CommitmentKey key = commitmentKeyOf({ 5, 6, 7 }, 6);
+    CommitmentKey copy = key;
+    assert(copy.size == 3 && copy[2] == 7 && copy.vk == 6 && copy.storage);
+    std::cout << "json key: ok\n";
+}
+
+int main() {
+    test_prefix_views();
+    test_rejects_bad_files();
+    test_json_key();
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "lib/verifierService.h"
+#include "lib/mqttPublisher.h"
+#include <iostream>
+#include <string>
+#include <csignal>
+#include <mosquitto.h>
+
+using namespace std;
+
+static atomic<bool> running{ true };
+
+struct Options {
+  string socketPath;
+  string mqttHost;
+  int mqttPort = 1883;
+  string topic = "+";
+  string verdictPrefix = "verdicts/";
+  string format = "json";
+  size_t workers = 0;               // 0: one per core
+  size_t queueCapacity = 1024;
+  size_t cacheCapacity = 16;
+  int reportSeconds = 10;
+};
+
+struct MqttInput {
+  VerifierService* service;
+  MqttPublisher* publisher;
+  const Options* options;
+  PayloadFormat format;
+};
+
+void on_connect(struct mosquitto *mosq, void *obj, int rc) {
+  MqttInput* input = static_cast<MqttInput*>(obj);
+  if (rc != 0) {
+    cerr << "Failed to connect to the MQTT broker: " << mosquitto_connack_string(rc) << endl;
+    return;
+  }
+  cout << "Connected to the MQTT broker, subscribing to " << input->options->topic << endl;
+  input->publisher->connected(true);
+  mosquitto_subscribe(mosq, nullptr, input->options->topic.c_str(), 0);
+}
+void on_disconnect(struct mosquitto *mosq, void *obj, int rc) {
+  static_cast<MqttInput*>(obj)->publisher->connected(false);
+}
+void on_publish(struct mosquitto *mosq, void *obj, int mid) {
+  static_cast<MqttInput*>(obj)->publisher->published(mid);
+}
+// Runs on the mosquitto network thread, so a full queue drops the proof instead of blocking
+void on_message(struct mosquitto *mosq, void *obj, const struct mosquitto_message *message) {
+  MqttInput* input = static_cast<MqttInput*>(obj);
+  string topic = message->topic;
+  if (topic.compare(0, input->options->verdictPrefix.size(), input->options->verdictPrefix) == 0) {
+    return;
+  }
+  string payload((const char*)message->payload, size_t(message->payloadlen));
+  MqttPublisher* publisher = input->publisher;
+  string verdictTopic = input->options->verdictPrefix + topic;
+  input->service->submit(std::move(payload), input->format, [publisher, verdictTopic](const Verdict& verdict) {
+    publisher->publish(verdictTopic, verdict.toJson());
+  }, false);
+}
+
+void printReport(VerifierService& service, CommitmentCache& cache) {
+  cout << "verified " << service.verifiedCount << ", failed " << service.failedCount << ", rejected " << service.rejected()
+       << ", queued " << service.pending() << ", commitment cache " << cache.hits() << " hits / " << cache.misses() << " misses" << endl;
+  cout << "  total  " << service.totalLatency.summary() << endl;
+  cout << "  queue  " << service.queueLatency.summary() << endl;
+  cout << "  verify " << service.verifyLatency.summary() << endl;
+}
+
+// Usage: ./verifierService [--socket path] [--mqtt host[:port]] [--topic filter]
+//                          [--format json|cbor|msgpack] [--workers n] [--queue n]
+//                          [--cache n] [--report seconds]
+// Without --mqtt the service listens on data/verifier.sock.
+int main(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--socket" && hasValue) {
+      options.socketPath = argv[++i];
+    } else if (arg == "--mqtt" && hasValue) {
+      options.mqttHost = argv[++i];
+      size_t colon = options.mqttHost.rfind(':');
+      if (colon != string::npos) {
+        options.mqttPort = stoi(options.mqttHost.substr(colon + 1));
+        options.mqttHost = options.mqttHost.substr(0, colon);
+      }
+    } else if (arg == "--topic" && hasValue) {
+      options.topic = argv[++i];
+    } else if (arg == "--format" && hasValue) {
+      options.format = argv[++i];
+    } else if (arg == "--workers" && hasValue) {
+      options.workers = stoul(argv[++i]);
+    } else if (arg == "--queue" && hasValue) {
+      options.queueCapacity = stoul(argv[++i]);
+    } else if (arg == "--cache" && hasValue) {
+      options.cacheCapacity = stoul(argv[++i]);
+    } else if (arg == "--report" && hasValue) {
+      options.reportSeconds = stoi(argv[++i]);
+    } else {
+      cerr << "Unknown option " << arg << endl;
+      return 1;
+    }
+  }
+  if (options.socketPath.empty() && options.mqttHost.empty()) {
+    options.socketPath = "data/verifier.sock";
+  }
+  PayloadFormat format = parsePayloadFormat(options.format);
+
+  signal(SIGINT, [](int) { running = false; });
+  signal(SIGTERM, [](int) { running = false; });
+
+  CommitmentCache cache(options.cacheCapacity, loadCommitmentById);
+  VerifierService service(cache, options.workers, options.queueCapacity);
+
+  UnixSocketInput socketInput(service, format);
+  if (!options.socketPath.empty()) {
+    if (!socketInput.start(options.socketPath)) {
+      return 1;
+    }
+    cout << "Listening on " << options.socketPath << endl;
+  }
+
+  struct mosquitto *mosq = nullptr;
+  unique_ptr<MqttPublisher> publisher;
+  MqttInput mqttInput{ &service, nullptr, &options, format };
+  if (!options.mqttHost.empty()) {
+    mosquitto_lib_init();
+    mosq = mosquitto_new(nullptr, true, &mqttInput);
+    if (!mosq) {
+      cerr << "Failed to create the MQTT client" << endl;
+      return 1;
+    }
+    publisher.reset(new MqttPublisher(mosq, options.queueCapacity));
+    mqttInput.publisher = publisher.get();
+    mosquitto_connect_callback_set(mosq, on_connect);
+    mosquitto_disconnect_callback_set(mosq, on_disconnect);
+    mosquitto_publish_callback_set(mosq, on_publish);
+    mosquitto_message_callback_set(mosq, on_message);
+    int rc = mosquitto_connect(mosq, options.mqttHost.c_str(), options.mqttPort, 30);
+    if (rc != MOSQ_ERR_SUCCESS) {
+      cerr << "Could not connect to " << options.mqttHost << ":" << options.mqttPort << ": " << mosquitto_strerror(rc) << endl;
+      return 1;
+    }
+    // The publisher owns the network loop
+    publisher->start();
+  }
+
+  int elapsed = 0;
+  while (running) {
+    this_thread::sleep_for(chrono::seconds(1));
+    if (options.reportSeconds > 0 && ++elapsed % options.reportSeconds == 0) {
+      printReport(service, cache);
+    }
+  }
+
+  cout << "Stopping" << endl;
+  socketInput.stop();
+  if (mosq) {
+    mosquitto_unsubscribe(mosq, nullptr, options.topic.c_str());
+  }
+  service.stop();
+  if (publisher) {
+    publisher->flush(2000);
+    publisher->stop();
+    mosquitto_destroy(mosq);
+    mosquitto_lib_cleanup();
+  }
+  printReport(service, cache);
+  return 0;
+}
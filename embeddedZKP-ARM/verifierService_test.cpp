@@ -0,0 +1,186 @@
+// Copyright 2025 Fidesinnova.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the commitment cache, the latency histogram and the worker pool, and
+// sends data/proof.json through the Unix socket input.
+// `g++ -std=c++17 verifierService_test.cpp lib/verifierService.cpp lib/proofVerifier.cpp lib/verifyingKey.cpp lib/polynomial.cpp lib/proofEnvelope.cpp lib/srs.cpp -o verifierService_test -lpthread`
+
+#include "lib/verifierService.h"
+#include "lib/logger.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+string readFile(const string& path) {
+    std::ifstream file(path);
+    assert(file.is_open());
+    stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+void test_cache() {
+    atomic<int> loads{ 0 };
+    CommitmentCache cache(2, [&](const string& id) -> CommitmentCache::Key {
+        loads++;
+        this_thread::sleep_for(chrono::milliseconds(20));
+        if (id == "missing") {
+            return nullptr;
+        }
+        auto key = make_shared<VerifyingKey>();
+        key->commitmentId = id;
+        return key;
+    });
+
+    // Concurrent misses for one id load it once
+    vector<thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&]() {
+            CommitmentCache::Key key = cache.get("a");
+            assert(key->commitmentId == "a");
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    assert(loads == 1 && cache.misses() == 1 && cache.hits() == 3);
+
+    // "a" was used last, so "b" is evicted by "c"
+    cache.get("b");
+    cache.get("a");
+    cache.get("c");
+    assert(cache.size() == 2 && loads == 3);
+    cache.get("a");
+    assert(loads == 3);
+    cache.get("b");
+    assert(loads == 4);
+
+    // Unknown commitments are not cached
+    CommitmentCache::Key first = cache.get("missing");
+    CommitmentCache::Key second = cache.get("missing");
+    assert(!first && !second);
+    assert(loads == 6 && cache.size() == 2);
+    std::cout << "cache: ok\n";
+}
+
+void test_histogram() {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 90; i++) {
+        histogram.record(chrono::microseconds(100));
+    }
+    for (int i = 0; i < 10; i++) {
+        histogram.record(chrono::microseconds(5000));
+    }
+    assert(histogram.count() == 100);
+    assert(histogram.quantile(0.5) == 128 && histogram.quantile(0.9) == 128);
+    assert(histogram.quantile(0.99) == 8192);
+    std::cout << "histogram: ok\n";
+}
+
+void test_service(const string& proof) {
+    CommitmentCache cache(4, loadCommitmentById);
+    VerifierService service(cache, 4, 8);
+
+    ordered_json tampered = ordered_json::parse(proof);
+    tampered["P_AHP10"] = tampered["P_AHP10"].get<uint64_t>() + 1;
+    ordered_json unknown = ordered_json::parse(proof);
+    unknown["commitmentId"] = "00";
+
+    mutex lock;
+    vector<Verdict> verdicts;
+    auto reply = [&](const Verdict& verdict) {
+        lock_guard<mutex> guard(lock);
+        verdicts.push_back(verdict);
+    };
+    PayloadFormat json = parsePayloadFormat("json");
+    int queued = 0;
+    for (int i = 0; i < 20; i++) {
+        queued += service.submit(proof, json, reply, true);
+    }
+    queued += service.submit(tampered.dump(), json, reply, true);
+    queued += service.submit(unknown.dump(), json, reply, true);
+    queued += service.submit("{ not json", json, reply, true);
+    assert(queued == 23);
+    service.stop();
+
+    assert(verdicts.size() == 23);
+    assert(service.verifiedCount == 20 && service.failedCount == 3);
+    assert(service.totalLatency.count() == 23);
+    // One commitment: loaded once, whichever worker got there first
+    assert(cache.misses() == 2);
+    int errors = 0;
+    for (const Verdict& verdict : verdicts) {
+        errors += !verdict.error.empty();
+    }
+    assert(errors == 2);
+    std::cout << "service: ok\n";
+}
+
+void test_socket(const string& proof) {
+    const string path = "verifierService_test.sock";
+    CommitmentCache cache(4, loadCommitmentById);
+    VerifierService service(cache, 2, 4);
+    UnixSocketInput input(service, parsePayloadFormat("json"));
+    bool started = input.start(path);
+    assert(started);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    int connected = connect(fd, (struct sockaddr*)&address, sizeof(address));
+    assert(connected == 0);
+
+    const int frames = 3;
+    for (int i = 0; i < frames; i++) {
+        uint32_t length = uint32_t(proof.size());
+        unsigned char header[4] = { (unsigned char)(length >> 24), (unsigned char)(length >> 16), (unsigned char)(length >> 8), (unsigned char)length };
+        ssize_t written = write(fd, header, 4);
+        assert(written == 4);
+        written = write(fd, proof.data(), proof.size());
+        assert(written == ssize_t(proof.size()));
+    }
+
+    string replies;
+    char buffer[512];
+    while (count(replies.begin(), replies.end(), '\n') < frames) {
+        ssize_t received = read(fd, buffer, sizeof(buffer));
+        assert(received > 0);
+        replies.append(buffer, size_t(received));
+    }
+    istringstream lines(replies);
+    string line;
+    while (getline(lines, line)) {
+        assert(nlohmann::json::parse(line)["verified"].get<bool>());
+    }
+    close(fd);
+    input.stop();
+    service.stop();
+    assert(access(path.c_str(), F_OK) != 0);
+    std::cout << "socket: ok\n";
+}
+
+int main() {
+    setLogLevel(LogLevel::Error);
+    string proof = readFile("data/proof.json");
+    test_cache();
+    test_histogram();
+    test_service(proof);
+    test_socket(proof);
+    return 0;
+}
@@ -40,7 +40,7 @@ case $user_choice in
 
         # Step 2: Find the line number that uses 'mul' after '#APP' in program.s
         echo "[2/$total_steps] Finding the first instruction after '#APP' in program.s"
-        line_number=$(awk '/#APP/{flag=1; next} flag && /add|mul/{print NR; exit}' program.s)
+        line_number=$(awk '/#APP/{flag=1; next} flag && ($1 == "add" || $1 == "mul"){print NR; exit}' program.s)
         if [ -z "$line_number" ]; then
             echo "No relevent instruction found after '#APP'"
             exit 1
@@ -79,25 +79,33 @@ case $user_choice in
         # Step 3: Read the class value from device_config.json
         echo "[3/$total_steps] Reading class value from device_config.json"
         config_file="device_config.json"
-        class_value=$(jq -r '.class' "$config_file")
-        if [ -z "$class_value" ]; then
-            echo "Class value not found in device_config.json"
-            exit 1
-        fi
+        class_value=$(jq -r '.class // empty' "$config_file")
+
+        if [ -n "$class_value" ]; then
+            # Step 4: Read n_g from class.json based on the class value
+            echo "[4/$total_steps] Reading relevant info from class.json based on class value"
+            class_file="class.json"
+            n_g=$(jq --arg class_value "$class_value" '.[$class_value].n_g' "$class_file")
+            if [ -z "$n_g" ] || [ "$n_g" = "null" ]; then
+                echo "n_g not found for class $class_value in class.json"
+                exit 1
+            fi
 
-        # Step 4: Read n_g from class.json based on the class value
-        echo "[4/$total_steps] Reading relevant info from class.json based on class value"
-        class_file="class.json"
-        n_g=$(jq --arg class_value "$class_value" '.[$class_value].n_g' "$class_file")
-        if [ -z "$n_g" ]; then
-            echo "n_g not found for class $class_value in class.json"
-            exit 1
+            # Step 5: Calculate the new values for code_block
+            echo "[5/$total_steps] Calculating new values for code_block"
+            second_value=$((line_number + n_g -1))
+        else
+            # Steps 4-5: Without a class the code block runs up to '#NO_APP' and the
+            # commitmentGenerator picks the smallest class that fits it
+            echo "[4/$total_steps] No class in device_config.json; it is selected from the code block"
+            echo "[5/$total_steps] Finding the last instruction before '#NO_APP' in program.s"
+            second_value=$(awk -v start="$line_number" 'NR >= start && /#NO_APP/{print last; exit} NR >= start && ($1 == "add" || $1 == "mul"){last = NR}' program.s)
+            if [ -z "$second_value" ]; then
+                echo "No '#NO_APP' found after line $line_number in program.s"
+                exit 1
+            fi
         fi
 
-        # Step 5: Calculate the new values for code_block
-        echo "[5/$total_steps] Calculating new values for code_block"
-        second_value=$((line_number + n_g -1))
-
         # Step 6: Update device_config.json with the new values
         echo "[6/$total_steps] Updating device_config.json 'code_block' with new values"
         temp_file=$(mktemp)
@@ -114,10 +122,13 @@ case $user_choice in
             echo "commitmentGenerator execution failed"
             exit 1
         fi
+        if grep -q "^Cache hit" log/commitmentGenerator.log; then
+            echo "      The code block is unchanged; the existing commitment is reused"
+        fi
 
         # Step 8: Build the program_new.s using the updated codes and store the output logs
         echo "[8/$total_steps] Build the executable from program_new.s"
-        g++ -std=c++17 program_new.s lib/polynomial.cpp -o program -lstdc++ -lmosquitto -lpthread
+        g++ -std=c++17 program_new.s lib/polynomial.cpp lib/asyncProver.cpp lib/blindingPool.cpp lib/serialReader.cpp lib/mqttPublisher.cpp lib/proofEnvelope.cpp lib/srs.cpp -o program -lstdc++ -lmosquitto -lpthread
         if [ $? -ne 0 ]; then
             echo "Build failed"
             exit 1